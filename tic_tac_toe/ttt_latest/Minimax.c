@@ -17,9 +17,10 @@ static int winMinimax(int b[9]) {
     return 0; // no winner
 }
 
-// alpha beta pruning minimax
-static int minimax_inner_ab(int b[9], int player, int alpha, int beta)
+// alpha beta pruning minimax; counts every position it visits in *nodes
+static int minimax_inner_ab(int b[9], int player, int alpha, int beta, long long *nodes)
 {
+    (*nodes)++;
     int w = winMinimax(b);
     if (w) return w * player;   // terminal score if someone has won
 
@@ -33,7 +34,7 @@ static int minimax_inner_ab(int b[9], int player, int alpha, int beta)
             b[i] = player;      // make move
 
             // recursive call with roles swapped
-            int score = -minimax_inner_ab(b, -player, -beta, -alpha);
+            int score = -minimax_inner_ab(b, -player, -beta, -alpha, nodes);
             b[i] = 0;           // undo move
 
             if (score > best) best = score;   // update best score
@@ -48,7 +49,7 @@ static int minimax_inner_ab(int b[9], int player, int alpha, int beta)
 }
 
 // choose best move for O using minimax
-int bestMove_minimax(Cell board[3][3], int depthLimit, int blunderPct) {
+static int minimax_search(Cell board[3][3], int depthLimit, int blunderPct, long long *nodes) {
     int arr[9], move = -1, best = -999, emptyCount = 0;
 
     // Convert board to 1D int array
@@ -69,7 +70,7 @@ int bestMove_minimax(Cell board[3][3], int depthLimit, int blunderPct) {
         arr[i] = -1; // simulate O move
 
         // evaluate move using minimax
-        int sc = -minimax_inner_ab(arr, +1, -2, +2);
+        int sc = -minimax_inner_ab(arr, +1, -2, +2, nodes);
         arr[i] = 0; // undo move
 
         // apply blunder chance for difficulty adjustment
@@ -88,13 +89,20 @@ int bestMove_minimax(Cell board[3][3], int depthLimit, int blunderPct) {
     return move; // return best move index
 }
 
-// allow minimax to play as X or O
-int bestMove_minimax_for(Cell board[3][3], Cell aiPiece,
-                         int depthLimit, int blunderPct)
+int bestMove_minimax(Cell board[3][3], int depthLimit, int blunderPct) {
+    long long nodes = 0;
+    return minimax_search(board, depthLimit, blunderPct, &nodes);
+}
+
+// allow minimax to play as X or O; *nodes = positions searched
+// (0 when it took the centre without searching)
+int bestMove_minimax_nodes(Cell board[3][3], Cell aiPiece,
+                           int depthLimit, int blunderPct, long long *nodes)
 {
+    *nodes = 0;
     // if minimax is O, use normal routine
     if (aiPiece == O) {
-        return bestMove_minimax(board, depthLimit, blunderPct);
+        return minimax_search(board, depthLimit, blunderPct, nodes);
     }
 
     // minimax is X: swap X<->O and reuse normal routine
@@ -109,5 +117,12 @@ int bestMove_minimax_for(Cell board[3][3], Cell aiPiece,
         }
 
     // run solver on swapped board
-    return bestMove_minimax(swp, depthLimit, blunderPct);
+    return minimax_search(swp, depthLimit, blunderPct, nodes);
+}
+
+int bestMove_minimax_for(Cell board[3][3], Cell aiPiece,
+                         int depthLimit, int blunderPct)
+{
+    long long nodes;
+    return bestMove_minimax_nodes(board, aiPiece, depthLimit, blunderPct, &nodes);
 }
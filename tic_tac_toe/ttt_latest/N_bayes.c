@@ -6,6 +6,9 @@
 #include <math.h>
 #include <time.h>
 #include <SDL2/SDL.h>
+#ifndef _WIN32
+#include <sys/types.h>   // off_t for fseeko
+#endif
 
 typedef enum { EMPTY=0, X=1, O=2 } Cell;
 int find_blocking_move_against_ai(Cell b[3][3], Cell aiPiece);
@@ -13,17 +16,415 @@ int find_blocking_move_against_ai(Cell b[3][3], Cell aiPiece);
 
 // --- NB model ---
 typedef struct {
-    int counts[2][9][3];  // class (0=neg,1=pos) x feature x token (b,x,o)
-    int classCount[2];
-    int totalRows;
+    long long counts[2][9][3];  // class (0=neg,1=pos) x feature x token (b,x,o)
+    long long classCount[2];
+    long long totalRows;        // 64-bit: deduplicated rows carry large weights
     int trained;
+    int canonical;        // trained on canonical boards: queries get canonicalized too
 } NBModel;
 
 static NBModel nb = {0};
 
+// Precomputed log-probabilities of a model, so scoring a row is 18
+// table lookups. Laplace smoothing done to prevent any 0's from happening.
+typedef struct {
+    double logPrior[2];
+    double logCond[2][9][3];
+} NBLogTable;
+
+static void nb_build_log_table(const NBModel *m, NBLogTable *lt)
+{
+    for (int cls = 0; cls < 2; cls++) {
+        lt->logPrior[cls] = log((m->classCount[cls] + 1.0) / (m->totalRows + 2.0));
+        double den = m->classCount[cls] + 3.0;
+        for (int i = 0; i < 9; i++)
+            for (int t = 0; t < 3; t++)
+                lt->logCond[cls][i][t] = log((m->counts[cls][i][t] + 1.0) / den);
+    }
+}
+
+// 1 if the table predicts "X wins" (P >= 0.5), else 0
+static int nb_log_table_predict(const NBLogTable *lt, const int feat[9])
+{
+    double lp1 = lt->logPrior[1], lp0 = lt->logPrior[0];
+    for (int i = 0; i < 9; i++) {
+        lp1 += lt->logCond[1][i][feat[i]];
+        lp0 += lt->logCond[0][i][feat[i]];
+    }
+    return lp1 >= lp0;
+}
+
+// Log tables of the live model. Online learning only bumps counts and
+// marks them stale; they are rebuilt on the next prediction.
+static NBLogTable nbLog;
+static int nbLogDirty = 1;
+
+// --- Board symmetries ---
+// The 8 rotations/reflections of the board: variant[i] = board[nbSym[k][i]]
+static const int nbSym[8][9] = {
+    {0,1,2,3,4,5,6,7,8},
+    {2,1,0,5,4,3,8,7,6},
+    {6,3,0,7,4,1,8,5,2},
+    {0,3,6,1,4,7,2,5,8},
+    {8,7,6,5,4,3,2,1,0},
+    {6,7,8,3,4,5,0,1,2},
+    {2,5,8,1,4,7,0,3,6},
+    {8,5,2,7,4,1,6,3,0},
+};
+
+#define NB_CODES 19683   // 3^9 possible boards
+
+// Board as a base-3 number: cell i (= r*3+c) is digit i, 0=b 1=x 2=o
+int board_code(const int feat[9]){
+    int code = 0;
+    for (int i = 8; i >= 0; i--) code = code * 3 + feat[i];
+    return code;
+}
+
+static void nb_decode_board(int code, int feat[9]){
+    for (int i = 0; i < 9; i++) { feat[i] = code % 3; code /= 3; }
+}
+
+// Smallest code among the 8 symmetric variants, so boards that are
+// rotations or reflections of each other get the same code.
+int board_canonical_code(const int feat[9]){
+    int best = NB_CODES;
+    for (int k = 0; k < 8; k++) {
+        int code = 0;
+        for (int i = 8; i >= 0; i--) code = code * 3 + feat[nbSym[k][i]];
+        if (code < best) best = code;
+    }
+    return best;
+}
+
 static int Tok(const char* s){ return (s[0]=='b')?0:(s[0]=='x')?1:2; } // b,x,o
 static int Lab(const char* s){ return (s[0]=='p')?1:0; }              // positive means X wins
+
+// ---------------------------------------------------------------
+// Streaming dataset helpers
+// Rows are parsed in place (no strtok copy) and files are read in
+// binary mode so byte offsets are exact and can be split by thread.
+// ---------------------------------------------------------------
+#ifdef _WIN32
+#define nb_fseek(f, off, whence) _fseeki64((f), (long long)(off), (whence))
+#define nb_ftell(f)              ((long long)_ftelli64(f))
+#else
+#define nb_fseek(f, off, whence) fseeko((f), (off_t)(off), (whence))
+#define nb_ftell(f)              ((long long)ftello(f))
+#endif
+
+#define NB_MAX_FOLDS   32
+#define NB_MAX_THREADS 64
+
+// Parses "x,o,b,...,positive" into features + class.
+// Returns 0 for blank, header or truncated lines.
+static int nb_parse_row(const char *s, int feat[9], int *cls)
+{
+    for (int i = 0; i < 9; i++) {
+        if (*s != 'b' && *s != 'x' && *s != 'o') return 0;
+        feat[i] = Tok(s);
+        while (*s && *s != ',' && *s != '\n') s++;
+        if (*s++ != ',') return 0;
+    }
+    if (*s != 'p' && *s != 'n') return 0;
+    *cls = Lab(s);
+    return 1;
+}
+
+static long long nb_file_size(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    nb_fseek(f, 0, SEEK_END);
+    long long size = nb_ftell(f);
+    fclose(f);
+    return size;
+}
+
+typedef void (*NBRowFn)(void *ctx, long long offset, const int feat[9], int cls);
+
+// Calls fn for every row whose first byte lies in [start, end).
+// Ranges that tile the file visit each row exactly once, so threads can
+// split one file between them. The file is read in 64 KB blocks and
+// rows are parsed straight out of the block.
+// Returns the number of rows visited, or -1 if the file can't be opened.
+static long long nb_scan_range(const char *path, long long start, long long end,
+                               NBRowFn fn, void *ctx)
+{
+    enum { NB_BLOCK = 1 << 16 };
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    char *buf = malloc(NB_BLOCK + 1);
+    if (!buf) { fclose(f); return -1; }
+
+    // the row that straddles our start belongs to the previous range
+    long long pos = (start > 0) ? start - 1 : 0;   // file offset of buf[0]
+    int skipping  = (start > 0);
+    if (pos > 0) nb_fseek(f, pos, SEEK_SET);
+
+    long long rows = 0;
+    size_t have = 0;
+    int done = 0;
+    while (!done) {
+        size_t got = fread(buf + have, 1, NB_BLOCK - have, f);
+        size_t len = have + got;
+        if (len == 0) break;
+        buf[len] = '\0';
+
+        size_t i = 0;
+        while (i < len) {
+            char *nl = memchr(buf + i, '\n', len - i);
+            if (!nl) {
+                if (got > 0) break;          // incomplete row, read more
+                nl = buf + len;              // last row has no newline
+            }
+            long long rowStart = pos + (long long)i;
+            if (skipping) {
+                skipping = 0;
+            } else if (rowStart >= end) {
+                done = 1;
+                break;
+            } else {
+                int feat[9], cls;
+                if (nb_parse_row(buf + i, feat, &cls)) {
+                    fn(ctx, rowStart, feat, cls);
+                    rows++;
+                }
+            }
+            i = (size_t)(nl - buf) + 1;
+        }
+        if (got == 0) break;
+        if (i > len) i = len;
+
+        // keep the incomplete row for the next read
+        memmove(buf, buf + i, len - i);
+        have = len - i;
+        pos += (long long)i;
+        if (have == NB_BLOCK) {              // a "row" longer than a block: drop it
+            pos += have;
+            have = 0;
+            skipping = 1;
+        }
+    }
+    free(buf);
+    fclose(f);
+    return rows;
+}
+
+// Same as nb_scan_range for the 2-byte records written by
+// "--selfplay out.ttb": bits 0..14 hold the board as a base-3 number
+// (cell r*3+c is digit r*3+c, 0=b 1=x 2=o), bit 15 is the label.
+static long long nb_scan_range_bin(const char *path, long long start, long long end,
+                                   NBRowFn fn, void *ctx)
+{
+    enum { NB_BLOCK = 1 << 16 };
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    unsigned char *buf = malloc(NB_BLOCK);
+    if (!buf) { fclose(f); return -1; }
+
+    long long pos = (start + 1) & ~1LL;   // first whole record in range
+    nb_fseek(f, pos, SEEK_SET);
+    long long rows = 0;
+    while (pos < end) {
+        long long want = end - pos;
+        if (want > NB_BLOCK) want = NB_BLOCK;
+        want = (want + 1) & ~1LL;
+        size_t got = fread(buf, 1, (size_t)want, f) & ~(size_t)1;
+        if (got == 0) break;
+        for (size_t i = 0; i < got; i += 2, pos += 2) {
+            unsigned code = buf[i] | ((unsigned)buf[i + 1] << 8);
+            int feat[9];
+            int cls = (int)(code >> 15);
+            code &= 0x7FFF;
+            for (int c = 0; c < 9; c++) { feat[c] = (int)(code % 3); code /= 3; }
+            fn(ctx, pos, feat, cls);
+            rows++;
+        }
+    }
+    free(buf);
+    fclose(f);
+    return rows;
+}
+
+// Picks the reader from the file name: *.ttb is binary, the rest CSV
+static long long nb_scan_any(const char *path, long long start, long long end,
+                             NBRowFn fn, void *ctx)
+{
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".ttb") == 0)
+        return nb_scan_range_bin(path, start, end, fn, ctx);
+    return nb_scan_range(path, start, end, fn, ctx);
+}
+
+// Runs fn on n jobs (stride bytes apart in one array), one thread per
+// job, and waits for all of them.
+static void nb_run_threads(SDL_ThreadFunction fn, void *jobs, size_t stride, int n)
+{
+    SDL_Thread *threads[NB_MAX_THREADS];
+    for (int t = 0; t < n; t++) {
+        void *job = (char *)jobs + stride * (size_t)t;
+        threads[t] = (n > 1) ? SDL_CreateThread(fn, "nb_worker", job) : NULL;
+        if (!threads[t]) fn(job);   // single job or no thread: run it here
+    }
+    for (int t = 0; t < n; t++)
+        if (threads[t]) SDL_WaitThread(threads[t], NULL);
+}
  
+// ---------------------------------------------------------------
+// Sharded training
+// The input files are cut into byte-range shards that worker threads
+// pull from a shared counter. Each worker fills private count tables
+// and the tables are summed once everyone is done.
+// ---------------------------------------------------------------
+#define NB_SHARD_MIN_BYTES (1 << 20)   // below this a thread isn't worth it
+
+typedef struct {
+    const char *path;
+    long long start, end;
+} NBShard;
+
+typedef struct {
+    const NBShard *shards;
+    int nShards;
+    SDL_atomic_t *next;    // next shard to hand out
+    NBRowFn fn;
+    void *ctx;             // private to this worker, reduced by the caller
+    long long rows;
+    int failed;
+} NBScanWorker;
+
+static int nb_scan_worker(void *data)
+{
+    NBScanWorker *w = data;
+    for (;;) {
+        int s = SDL_AtomicAdd(w->next, 1);
+        if (s >= w->nShards) break;
+        long long n = nb_scan_any(w->shards[s].path, w->shards[s].start, w->shards[s].end,
+                                  w->fn, w->ctx);
+        if (n < 0) w->failed = 1;
+        else w->rows += n;
+    }
+    return 0;
+}
+
+// Streams every row of the files through fn. nThreads <= 0 means one
+// per CPU (small inputs get fewer). Each thread gets its own zeroed
+// ctxSize-byte context; *ctxsOut receives the array of them (caller
+// frees) and *usedThreads its length. Returns the rows visited, or -1
+// if a file can't be read.
+static long long nb_scan_files(const char *const *paths, int nPaths, int nThreads,
+                               NBRowFn fn, size_t ctxSize, void **ctxsOut, int *usedThreads)
+{
+    *ctxsOut = NULL;
+    *usedThreads = 0;
+    long long total = 0;
+    long long *sizes = malloc(sizeof(long long) * (size_t)(nPaths > 0 ? nPaths : 1));
+    if (!sizes) return -1;
+    for (int p = 0; p < nPaths; p++) {
+        sizes[p] = nb_file_size(paths[p]);
+        if (sizes[p] < 0) { free(sizes); return -1; }
+        total += sizes[p];
+    }
+
+    if (nThreads <= 0) nThreads = SDL_GetCPUCount();
+    if ((long long)nThreads > total / NB_SHARD_MIN_BYTES + 1)
+        nThreads = (int)(total / NB_SHARD_MIN_BYTES + 1);
+    if (nThreads > NB_MAX_THREADS) nThreads = NB_MAX_THREADS;
+    if (nThreads < 1) nThreads = 1;
+
+    // ~4 shards per thread so one slow shard doesn't leave the rest idle
+    long long shardBytes = total / ((long long)nThreads * 4);
+    if (shardBytes < NB_SHARD_MIN_BYTES) shardBytes = NB_SHARD_MIN_BYTES;
+
+    int nShards = 0;
+    for (int p = 0; p < nPaths; p++)
+        nShards += (int)((sizes[p] + shardBytes - 1) / shardBytes);
+    NBShard *shards = malloc(sizeof(NBShard) * (size_t)(nShards > 0 ? nShards : 1));
+    NBScanWorker *workers = calloc((size_t)nThreads, sizeof *workers);
+    char *ctxs = calloc((size_t)nThreads, ctxSize);
+    if (!shards || !workers || !ctxs) {
+        free(sizes); free(shards); free(workers); free(ctxs);
+        return -1;
+    }
+    int k = 0;
+    for (int p = 0; p < nPaths; p++)
+        for (long long off = 0; off < sizes[p]; off += shardBytes) {
+            shards[k].path  = paths[p];
+            shards[k].start = off;
+            shards[k].end   = (off + shardBytes < sizes[p]) ? off + shardBytes : sizes[p];
+            k++;
+        }
+
+    SDL_atomic_t next;
+    SDL_AtomicSet(&next, 0);
+    for (int t = 0; t < nThreads; t++) {
+        workers[t].shards  = shards;
+        workers[t].nShards = nShards;
+        workers[t].next    = &next;
+        workers[t].fn      = fn;
+        workers[t].ctx     = ctxs + ctxSize * (size_t)t;
+    }
+    nb_run_threads(nb_scan_worker, workers, sizeof workers[0], nThreads);
+
+    long long rows = 0;
+    int failed = 0;
+    for (int t = 0; t < nThreads; t++) {
+        rows += workers[t].rows;
+        failed |= workers[t].failed;
+    }
+    free(sizes); free(shards); free(workers);
+    *ctxsOut = ctxs;
+    *usedThreads = nThreads;
+    return failed ? -1 : rows;
+}
+
+static void nb_train_count_row(void *ctx, long long offset, const int feat[9], int cls)
+{
+    NBModel *m = ctx;
+    (void)offset;
+    m->classCount[cls]++;
+    for (int i = 0; i < 9; i++) m->counts[cls][i][feat[i]]++;
+}
+
+// Adds the rows of all files to *out using private count tables per
+// thread, summed at the end. Returns the rows counted or -1.
+static long long nb_count_files(const char *const *paths, int nPaths, int nThreads,
+                                NBModel *out, int *usedThreads)
+{
+    void *ctxs;
+    int used;
+    long long rows = nb_scan_files(paths, nPaths, nThreads, nb_train_count_row,
+                                   sizeof(NBModel), &ctxs, &used);
+    for (int t = 0; t < used; t++) {
+        const NBModel *w = (const NBModel *)ctxs + t;
+        for (int cls = 0; cls < 2; cls++) {
+            out->classCount[cls] += w->classCount[cls];
+            for (int i = 0; i < 9; i++)
+                for (int tok = 0; tok < 3; tok++)
+                    out->counts[cls][i][tok] += w->counts[cls][i][tok];
+        }
+    }
+    out->totalRows = out->classCount[0] + out->classCount[1];
+    free(ctxs);
+    if (usedThreads) *usedThreads = used;
+    return rows;
+}
+
+// Trains the game model from one or more files split across threads.
+// Returns the number of rows read, or -1 if a file can't be read.
+long long nb_train_sharded(const char *const *paths, int nPaths, int nThreads)
+{
+    NBModel m = {0};            // replaces the model, never adds to it
+    long long rows = nb_count_files(paths, nPaths, nThreads, &m, NULL);
+    if (rows > 0) {
+        m.trained = 1;
+        nb = m;
+        nbLogDirty = 1;
+    }
+    return rows;
+}
+
 void nb_train_from_file(const char* path){
     FILE* f=fopen(path,"r");
     if (!f) {
@@ -39,52 +440,180 @@ void nb_train_from_file(const char* path){
 
     exit(EXIT_FAILURE);  // stop the entire program
     }
-    char line[256]; 
-    while(fgets(line,sizeof line,f)){ // Entire fgets() loop ensures parsing
-        char *sp=NULL;               // This means that if "b,b,x,x,o,b,b,o,x,positive"
-        int feat[9];                // It becomes [0,0,1,1,2,0,0,2,1]
-        int ok=1;
-        for(int i=0;i<9;i++){ 
-            char* t=(i==0)? strtok_r(line,",\r\n",&sp):strtok_r(NULL,",\r\n",&sp); 
-            if(!t){
-                ok=0;break;
-            } 
-            feat[i]=Tok(t); 
+    fclose(f);
+    // "b,b,x,x,o,b,b,o,x,positive" becomes [0,0,1,1,2,0,0,2,1] + class 1
+    nb_train_sharded(&path, 1, 0);
+}
+
+// Trains throwaway models with 1, 2, 4 ... maxThreads threads and
+// prints rows/second for each, to see how training scales.
+void nb_train_scaling_report(const char *const *paths, int nPaths, int maxThreads)
+{
+    if (maxThreads <= 0) maxThreads = SDL_GetCPUCount();
+    if (maxThreads > NB_MAX_THREADS) maxThreads = NB_MAX_THREADS;
+    if (maxThreads < 1) maxThreads = 1;
+
+    printf("Naive Bayes sharded training, %d file(s)\n", nPaths);
+    printf("threads          rows      secs        rows/s   speedup\n");
+    double baseRate = 0.0;
+    for (int t = 1; ; t *= 2) {
+        if (t > maxThreads) t = maxThreads;
+        NBModel *scratch = calloc(1, sizeof *scratch);
+        if (!scratch) return;
+        int used = t;
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        long long rows = nb_count_files(paths, nPaths, t, scratch, &used);
+        double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+        free(scratch);
+        if (rows < 0) {
+            fprintf(stderr, "[NB] Error opening dataset.\n");
+            return;
         }
-        char* lbl= ok? strtok_r(NULL,",\r\n",&sp):NULL; 
-        if(!lbl) 
-            continue;
-        int cls=Lab(lbl); 
-        nb.classCount[cls]++; 
-        nb.totalRows++;
-        for(int i=0;i<9;i++) nb.counts[cls][i][feat[i]]++;
+        double rate = (secs > 0) ? rows / secs : 0.0;
+        if (baseRate == 0.0) baseRate = rate;
+        printf("%7d  %12lld  %8.3f  %12.0f  %7.2fx\n",
+               used, rows, secs, rate, baseRate > 0 ? rate / baseRate : 0.0);
+        if (t == maxThreads) break;
     }
-    fclose(f); nb.trained=1;
 }
 
-static double nb_predict_logprob(int feat[9], int cls){  
-    // Laplace smoothing done to prevent any 0's from happening
-    double logp=0.0;
-    double prior=(nb.classCount[cls]+1.0)/(nb.totalRows+2.0);
-    logp += log(prior);
-    for(int i=0;i<9;i++){
-        double num = nb.counts[cls][i][feat[i]] + 1.0;
-        double den = nb.classCount[cls] + 3.0;
-        logp += log(num/den);
+static const NBLogTable *nb_live_log_table(void){
+    if (nbLogDirty) {
+        nb_build_log_table(&nb, &nbLog);
+        nbLogDirty = 0;
     }
-    return logp;
+    return &nbLog;
 }
 
 // public: P(X wins | board)
 static double nb_predict_prob_xwin(int feat[9]){
     if(!nb.trained || nb.totalRows==0) return 0.5;
-    double lp1 = nb_predict_logprob(feat, 1); // positive (X wins)
-    double lp0 = nb_predict_logprob(feat, 0); // negative
+    int canon[9];
+    if (nb.canonical) {
+        nb_decode_board(board_canonical_code(feat), canon);
+        feat = canon;
+    }
+    const NBLogTable *lt = nb_live_log_table();
+    double lp1 = lt->logPrior[1], lp0 = lt->logPrior[0]; // positive (X wins) / negative
+    for(int i=0;i<9;i++){
+        lp1 += lt->logCond[1][i][feat[i]];
+        lp0 += lt->logCond[0][i][feat[i]];
+    }
     double m = (lp1>lp0)? lp1:lp0;
     double a = exp(lp1-m), b=exp(lp0-m);
     return a/(a+b);
 }
 
+// Builds the log tables up front so that worker threads (self-play)
+// only ever read the model while they run.
+void nb_prepare_shared_reads(void){
+    nb_live_log_table();
+}
+
+// ---------------------------------------------------------------
+// Online learning from finished games
+// Every position reached in a game becomes one training row labelled
+// with the game's result (positive = X won), same as the UCI data.
+// ---------------------------------------------------------------
+#define NB_SNAPSHOT_PATH  "nb_model.dat"
+#define NB_SNAPSHOT_EVERY 10     // games between snapshots
+
+static int nbGamesSinceSnapshot = 0;
+static int nbSnapshotsHeld = 0;  // bulk learning: save once at the end
+
+static int nb_winner(const int feat[9]){
+    static const int lines[8][3] = {
+        {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6}
+    };
+    for (int i = 0; i < 8; i++) {
+        int v = feat[lines[i][0]];
+        if (v && v == feat[lines[i][1]] && v == feat[lines[i][2]]) return v;
+    }
+    return 0;
+}
+
+// Writes the count tables (text, so it survives compiler/ABI changes).
+// Goes through a temp file so a crash never leaves a half-written model.
+int nb_save_snapshot(const char *path){
+    char tmp[260];
+    snprintf(tmp, sizeof tmp, "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return 0;
+    fprintf(f, "nbmodel 2\n%lld %lld %lld %d\n",
+            nb.totalRows, nb.classCount[0], nb.classCount[1], nb.canonical);
+    for (int cls = 0; cls < 2; cls++)
+        for (int i = 0; i < 9; i++)
+            fprintf(f, "%lld %lld %lld\n", nb.counts[cls][i][0], nb.counts[cls][i][1], nb.counts[cls][i][2]);
+    int ok = (fclose(f) == 0);
+    if (ok) {
+        remove(path);   // rename() won't replace an existing file on Windows
+        ok = (rename(tmp, path) == 0);
+    }
+    if (ok) nbGamesSinceSnapshot = 0;
+    return ok;
+}
+
+// Loads a snapshot written by nb_save_snapshot. Returns 0 (and leaves
+// the model alone) if the file is missing or malformed.
+int nb_load_snapshot(const char *path){
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    NBModel m = {0};
+    int version = 0;
+    int ok = (fscanf(f, "nbmodel %d", &version) == 1 && (version == 1 || version == 2) &&
+              fscanf(f, "%lld %lld %lld", &m.totalRows, &m.classCount[0], &m.classCount[1]) == 3);
+    if (ok && version >= 2) ok = (fscanf(f, "%d", &m.canonical) == 1);
+    for (int cls = 0; ok && cls < 2; cls++)
+        for (int i = 0; ok && i < 9; i++)
+            ok = (fscanf(f, "%lld %lld %lld", &m.counts[cls][i][0], &m.counts[cls][i][1],
+                                        &m.counts[cls][i][2]) == 3);
+    fclose(f);
+    if (!ok || m.totalRows != m.classCount[0] + m.classCount[1]) return 0;
+    m.trained = 1;
+    nb = m;
+    nbLogDirty = 1;
+    return 1;
+}
+
+// Adds the positions of one finished game to the model: O(moves).
+// squares[i] is r*3+c of move i, pieces[i] the piece placed there.
+void nb_learn_from_game(const int squares[], const Cell pieces[], int n){
+    int feat[9] = {0};
+    int rows[9][9];
+    if (n > 9) n = 9;
+    for (int m = 0; m < n; m++) {
+        if (squares[m] < 0 || squares[m] > 8) return;   // corrupt game, skip it
+        feat[squares[m]] = (pieces[m] == X) ? 1 : 2;
+        if (nb.canonical) nb_decode_board(board_canonical_code(feat), rows[m]);
+        else memcpy(rows[m], feat, sizeof feat);
+    }
+    if (n == 0) return;
+
+    int cls = (nb_winner(feat) == X) ? 1 : 0;
+    for (int m = 0; m < n; m++) {
+        nb.classCount[cls]++;
+        nb.totalRows++;
+        for (int i = 0; i < 9; i++) nb.counts[cls][i][rows[m][i]]++;
+    }
+    nb.trained = 1;
+    nbLogDirty = 1;
+
+    if (++nbGamesSinceSnapshot >= NB_SNAPSHOT_EVERY && !nbSnapshotsHeld)
+        nb_save_snapshot(NB_SNAPSHOT_PATH);
+}
+
+// While on, learned games are only saved by nb_flush_snapshot()
+// (importing many games would otherwise rewrite the file every 10).
+void nb_hold_snapshots(int on){
+    nbSnapshotsHeld = on;
+}
+
+// Saves whatever was learned since the last periodic snapshot (on exit).
+void nb_flush_snapshot(void){
+    if (nbGamesSinceSnapshot > 0)
+        nb_save_snapshot(NB_SNAPSHOT_PATH);
+}
+
 // Helper used by both easy AI and wrapper
 double prob_x_wins_after_move(Cell b[3][3], int r, int c, Cell who){
     Cell t[3][3]; for(int i=0;i<3;i++) for(int j=0;j<3;j++) t[i][j]=b[i][j];
@@ -96,30 +625,30 @@ double prob_x_wins_after_move(Cell b[3][3], int r, int c, Cell who){
     return nb_predict_prob_xwin(feat);
 }
 
-// Easy AI: assume AI is O → choose move minimizing P(X wins)
-int bestMove_naive_bayes(Cell b[3][3]){
-    int best=-1, ties[9], tn=0; double bestScore=1e9;
+// Best move for aiPiece: O minimises P(X wins), X maximises it. Ties go
+// to ties[tieRand % count], so callers with their own RNG stay
+// reproducible (and never touch rand() from several threads).
+int bestMove_naive_bayes_r(Cell b[3][3], Cell aiPiece, unsigned tieRand){
+    int best=-1, ties[9], tn=0;
+    double bestScore = (aiPiece == O) ? 1e9 : -1.0;
     for(int r=0;r<3;r++) for(int c=0;c<3;c++) if (b[r][c]==EMPTY){
-        double p = prob_x_wins_after_move(b,r,c,O);
-        if (p < bestScore - 1e-9){ bestScore=p; best=r*3+c; tn=0; ties[tn++]=best; }
+        double p = prob_x_wins_after_move(b,r,c,aiPiece);
+        int better = (aiPiece == O) ? (p < bestScore - 1e-9) : (p > bestScore + 1e-9);
+        if (better){ bestScore=p; best=r*3+c; tn=0; ties[tn++]=best; }
         else if (fabs(p - bestScore) < 1e-9){ ties[tn++]=r*3+c; }
     }
-    if (tn>0) best = ties[rand()%tn];
+    if (tn>0) best = ties[tieRand%(unsigned)tn];
     return best;
 }
 
+// Easy AI: assume AI is O → choose move minimizing P(X wins)
+int bestMove_naive_bayes(Cell b[3][3]){
+    return bestMove_naive_bayes_r(b, O, (unsigned)rand());
+}
+
 // Wrapper: allow AI to be X or O
 int bestMove_naive_bayes_for(Cell b[3][3], Cell aiPiece){
-    if (aiPiece == O) return bestMove_naive_bayes(b);
-    // aiPiece == X: maximize P(X wins after placing X)
-    int best=-1, ties[9], tn=0; double bestScore=-1.0;
-    for(int r=0;r<3;r++) for(int c=0;c<3;c++) if (b[r][c]==EMPTY){
-        double p = prob_x_wins_after_move(b,r,c,X);
-        if (p > bestScore + 1e-9){ bestScore=p; best=r*3+c; tn=0; ties[tn++]=best; }
-        else if (fabs(p - bestScore) < 1e-9){ ties[tn++]=r*3+c; }
-    }
-    if (tn>0) best = ties[rand()%tn];
-    return best;
+    return bestMove_naive_bayes_r(b, aiPiece, (unsigned)rand());
 }
 
 // Detect a "one move away" win for the AI and return the cell
@@ -167,9 +696,17 @@ int find_blocking_move_against_ai(Cell b[3][3], Cell aiPiece)
 }
 
 typedef struct {
-    int TP, TN, FP, FN;
+    long long TP, TN, FP, FN;
 } ConfusionMatrix;
 
+static void cm_add(ConfusionMatrix *cm, int actual, int predicted, long long weight)
+{
+    if (actual == 1 && predicted == 1) cm->TP += weight;
+    else if (actual == 0 && predicted == 0) cm->TN += weight;
+    else if (actual == 0 && predicted == 1) cm->FP += weight;
+    else if (actual == 1 && predicted == 0) cm->FN += weight;
+}
+
 static void cm_update(ConfusionMatrix *cm, int actual, int predicted)
 /* actual: 0=negative, 1=positive  */
 /* predicted: 0=negative, 1=positive */
@@ -180,129 +717,184 @@ static void cm_update(ConfusionMatrix *cm, int actual, int predicted)
     else if (actual == 1 && predicted == 0) cm->FN++;
 }
 
-// Evaluate Naive Bayes on an 80:20 train:test split of the dataset.
-// This is for the *report* (prints to console); the game itself still
-// uses nb_train_from_file() like before.
-void nb_train_test_stats(const char *path)
+// ---------------------------------------------------------------
+// k-fold cross-validation
+// ---------------------------------------------------------------
+
+// Seeded fold assignment. A row is identified by its byte offset, so
+// the split is a fixed pseudo-random shuffle that doesn't depend on
+// the thread count or on holding the rows in memory.
+static int nb_fold_of(unsigned long long seed, long long offset, int k)
 {
-    enum {MAX_ROWS = 1000};
-    FILE *f = fopen(path, "r");
-    if (!f) {
-        fprintf(stderr, "[NB] Error opening dataset.\n");
-        return;
-    }
-    
-    // ---------------------------------------
-    // 1. Load entire dataset
-    // ---------------------------------------
-    int feat[MAX_ROWS][9];
-    int label[MAX_ROWS];
-    int rows = 0;
-
-    char line[256];
-    while (rows < MAX_ROWS && fgets(line, sizeof line, f)) {
-        char *sp = NULL;
-        int ok = 1;
-
-        for (int i = 0; i < 9; ++i) {
-            char *t = (i == 0) ? strtok_r(line, ",\r\n", &sp)
-                               : strtok_r(NULL, ",\r\n", &sp);
-            if (!t) { ok = 0; break; }
-            feat[rows][i] = Tok(t);
-        }
+    unsigned long long z = seed + (unsigned long long)offset * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (int)(z % (unsigned long long)k);
+}
 
-        char *lbl = ok ? strtok_r(NULL, ",\r\n", &sp) : NULL;
-        if (!lbl) continue;
+// Per-thread accumulators, merged after each pass
+typedef struct {
+    long long counts[NB_MAX_FOLDS][2][9][3];
+    long long classCount[NB_MAX_FOLDS][2];
+    ConfusionMatrix cmTrain, cmTest;   // summed over all folds
+} NBFoldStats;
 
-        label[rows] = Lab(lbl);
-        rows++;
-    }
-    fclose(f);
+typedef struct {
+    const char *path;
+    long long start, end;
+    int k;
+    unsigned long long seed;
+    const NBLogTable *tables;   // NULL = counting pass, else k fold models
+    NBFoldStats *stats;
+    long long rows;
+} NBFoldJob;
 
-    if (rows == 0) {
-        printf("[NB] Dataset empty.\n");
-        return;
+static void nb_fold_count_row(void *ctx, long long offset, const int feat[9], int cls)
+{
+    NBFoldJob *job = ctx;
+    int f = nb_fold_of(job->seed, offset, job->k);
+    job->stats->classCount[f][cls]++;
+    for (int i = 0; i < 9; i++) job->stats->counts[f][cls][i][feat[i]]++;
+}
+
+static void nb_fold_score_row(void *ctx, long long offset, const int feat[9], int cls)
+{
+    NBFoldJob *job = ctx;
+    int f = nb_fold_of(job->seed, offset, job->k);
+    for (int g = 0; g < job->k; g++) {
+        int predicted = nb_log_table_predict(&job->tables[g], feat);
+        // row is test data for its own fold, training data for the others
+        cm_update(g == f ? &job->stats->cmTest : &job->stats->cmTrain, cls, predicted);
     }
+}
 
-    // ---------------------------------------
-    // 2. STRATIFIED SAMPLING GOES HERE
-    // ---------------------------------------
+static int nb_fold_worker(void *data)
+{
+    NBFoldJob *job = data;
+    job->rows = nb_scan_any(job->path, job->start, job->end,
+                              job->tables ? nb_fold_score_row : nb_fold_count_row, job);
+    return 0;
+}
 
-    // ---- Stratified Sampling 80:20 ----T
-    int posCount = 0, negCount = 0;
-    for (int i = 0; i < rows; i++) {
-        if (label[i] == 1) posCount++;
-        else negCount++;
-    }
+static void nb_write_confusion_dat(const char *path, const ConfusionMatrix *cm)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) return;
+    fprintf(out, "# x   y   value   label\n");
+    fprintf(out, "1   2   %-5lld \"TP\\n%lld\"\n", cm->TP, cm->TP);
+    fprintf(out, "2   2   %-5lld \"FN\\n%lld\"\n", cm->FN, cm->FN);
+    fprintf(out, "1   1   %-5lld \"FP\\n%lld\"\n", cm->FP, cm->FP);
+    fprintf(out, "2   1   %-5lld \"TN\\n%lld\"\n", cm->TN, cm->TN);
+    fclose(out);
+}
 
-    int trainPos = (posCount * 8) / 10;
-    int trainNeg = (negCount * 8) / 10;
+// Evaluate Naive Bayes with k-fold cross-validation.
+// The file is streamed twice by nThreads workers (0 = one per CPU):
+// pass 1 fills per-fold count tables, pass 2 scores every row against
+// the model trained without its fold. Memory is O(k * threads), not
+// O(rows). Like before, this is for the *report*; the game still uses
+// nb_train_from_file() and the global model is left untouched.
+void nb_kfold_cross_validate(const char *path, int k, unsigned long long seed, int nThreads)
+{
+    if (k < 2) k = 2;
+    if (k > NB_MAX_FOLDS) k = NB_MAX_FOLDS;
+    if (nThreads <= 0) nThreads = SDL_GetCPUCount();
+    if (nThreads < 1) nThreads = 1;
+    if (nThreads > NB_MAX_THREADS) nThreads = NB_MAX_THREADS;
 
-    int isTrain[MAX_ROWS] = {0};
-    int posSeen = 0, negSeen = 0;
+    long long size = nb_file_size(path);
+    if (size < 0) {
+        fprintf(stderr, "[NB] Error opening dataset.\n");
+        return;
+    }
 
-    for (int i = 0; i < rows; i++) {
-        if (label[i] == 1) {
-            if (posSeen < trainPos) {
-                isTrain[i] = 1;
-                posSeen++;
-            }
-        } else {
-            if (negSeen < trainNeg) {
-                isTrain[i] = 1;
-                negSeen++;
-            }
-        }
+    NBFoldJob jobs[NB_MAX_THREADS];
+    NBFoldStats *stats = calloc((size_t)nThreads, sizeof *stats);
+    if (!stats) return;
+    for (int t = 0; t < nThreads; t++) {
+        jobs[t].path  = path;
+        jobs[t].start = size * t / nThreads;
+        jobs[t].end   = size * (t + 1) / nThreads;
+        jobs[t].k     = k;
+        jobs[t].seed  = seed;
+        jobs[t].tables = NULL;
+        jobs[t].stats = &stats[t];
+        jobs[t].rows  = 0;
     }
 
     // ---------------------------------------
-    // 3. Train NB using only training rows
+    // 1. Count pass: per-fold tables
     // ---------------------------------------
-    memset(&nb, 0, sizeof(nb));
-
-    for (int r = 0; r < rows; r++) {
-        if (!isTrain[r]) continue;
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    nb_run_threads(nb_fold_worker, jobs, sizeof jobs[0], nThreads);
 
-        int cls = label[r];
-        nb.classCount[cls]++;
-        nb.totalRows++;
+    long long rows = 0;
+    NBModel total = {0};
+    NBModel foldOnly[NB_MAX_FOLDS];
+    memset(foldOnly, 0, sizeof foldOnly);
+    for (int t = 0; t < nThreads; t++) {
+        rows += jobs[t].rows;
+        for (int f = 0; f < k; f++)
+            for (int cls = 0; cls < 2; cls++) {
+                foldOnly[f].classCount[cls] += stats[t].classCount[f][cls];
+                for (int i = 0; i < 9; i++)
+                    for (int tok = 0; tok < 3; tok++)
+                        foldOnly[f].counts[cls][i][tok] += stats[t].counts[f][cls][i][tok];
+            }
+    }
+    if (rows == 0) {
+        printf("[NB] Dataset empty.\n");
+        free(stats);
+        return;
+    }
+    for (int f = 0; f < k; f++)
+        for (int cls = 0; cls < 2; cls++) {
+            total.classCount[cls] += foldOnly[f].classCount[cls];
+            for (int i = 0; i < 9; i++)
+                for (int tok = 0; tok < 3; tok++)
+                    total.counts[cls][i][tok] += foldOnly[f].counts[cls][i][tok];
+        }
+    total.totalRows = total.classCount[0] + total.classCount[1];
 
-        for (int i = 0; i < 9; i++) {
-            nb.counts[cls][i][ feat[r][i] ]++;
+    // model for fold f = everything minus fold f
+    NBLogTable tables[NB_MAX_FOLDS];
+    for (int f = 0; f < k; f++) {
+        NBModel m = total;
+        for (int cls = 0; cls < 2; cls++) {
+            m.classCount[cls] -= foldOnly[f].classCount[cls];
+            for (int i = 0; i < 9; i++)
+                for (int tok = 0; tok < 3; tok++)
+                    m.counts[cls][i][tok] -= foldOnly[f].counts[cls][i][tok];
         }
+        m.totalRows = m.classCount[0] + m.classCount[1];
+        m.trained = 1;
+        nb_build_log_table(&m, &tables[f]);
     }
-    nb.trained = 1;
 
     // ---------------------------------------
-    // 4. Evaluate on both train and test sets
+    // 2. Score pass: merge confusion matrices
     // ---------------------------------------
-    ConfusionMatrix cmTrain = {0}, cmTest = {0};
+    for (int t = 0; t < nThreads; t++) jobs[t].tables = tables;
+    nb_run_threads(nb_fold_worker, jobs, sizeof jobs[0], nThreads);
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
 
-    // Training evaluation
-    for (int r = 0; r < rows; r++) {
-        if (!isTrain[r]) continue;
-
-        double p = nb_predict_prob_xwin(feat[r]);
-        int predicted = (p >= 0.5);
-        cm_update(&cmTrain, label[r], predicted);
-    }
-
-    // Testing evaluation
-    for (int r = 0; r < rows; r++) {
-        if (isTrain[r]) continue;
-
-        double p = nb_predict_prob_xwin(feat[r]);
-        int predicted = (p >= 0.5);
-        cm_update(&cmTest, label[r], predicted);
+    ConfusionMatrix cmTrain = {0}, cmTest = {0};
+    for (int t = 0; t < nThreads; t++) {
+        cmTrain.TP += stats[t].cmTrain.TP; cmTrain.TN += stats[t].cmTrain.TN;
+        cmTrain.FP += stats[t].cmTrain.FP; cmTrain.FN += stats[t].cmTrain.FN;
+        cmTest.TP  += stats[t].cmTest.TP;  cmTest.TN  += stats[t].cmTest.TN;
+        cmTest.FP  += stats[t].cmTest.FP;  cmTest.FN  += stats[t].cmTest.FN;
     }
+    free(stats);
 
     // Print stats...
-    int trainTotal   = cmTrain.TP + cmTrain.TN + cmTrain.FP + cmTrain.FN;
-    int testTotal    = cmTest.TP + cmTest.TN + cmTest.FP + cmTest.FN;
+    double trainTotal = (double)cmTrain.TP + cmTrain.TN + cmTrain.FP + cmTrain.FN;
+    double testTotal  = (double)cmTest.TP + cmTest.TN + cmTest.FP + cmTest.FN;
 
     double trainAcc  = (trainTotal > 0) ? 100.0 * (cmTrain.TP + cmTrain.TN) / trainTotal : 0.0;
     double testAcc   = (testTotal  > 0) ? 100.0 * (cmTest.TP + cmTest.TN) / testTotal  : 0.0;
-    
+
     FILE *out = fopen("nb_stats.dat", "w");
     if (out) {
         fprintf(out, "# dataset accuracy error\n");
@@ -310,24 +902,204 @@ void nb_train_test_stats(const char *path)
         fprintf(out, "test  %.2f %.2f\n",  testAcc, 100.0 - testAcc);
         fclose(out);
     }
-    printf("Naive Bayes 80:20 stratified train/test split on '%s'\n", path);
-    printf("Total rows: %d\n\n", rows);
+    nb_write_confusion_dat("nb_train_confusion.dat", &cmTrain);
+    nb_write_confusion_dat("nb_test_confusion.dat",  &cmTest);
+
+    printf("Naive Bayes %d-fold cross-validation on '%s' (seed %llu, %d threads)\n",
+           k, path, seed, nThreads);
+    printf("Total rows: %lld  (%.2f s, %.0f rows/s)\n\n",
+           rows, secs, secs > 0 ? rows / secs : 0.0);
 
     printf("Training accuracy   = %.2f%%  (error = %.2f%%)\n",
            trainAcc, 100.0 - trainAcc);
     printf("Testing  accuracy   = %.2f%%  (error = %.2f%%)\n\n",
            testAcc,  100.0 - testAcc);
 
-    printf("Training confusion matrix (actual rows vs predicted columns):\n");
+    printf("Training confusion matrix, summed over folds (actual rows vs predicted columns):\n");
     printf("              Predicted +   Predicted -\n");
-    printf("Actual +      %5d TP        %5d FN\n", cmTrain.TP, cmTrain.FN);
-    printf("Actual -      %5d FP        %5d TN\n\n", cmTrain.FP, cmTrain.TN);
+    printf("Actual +      %5lld TP        %5lld FN\n", cmTrain.TP, cmTrain.FN);
+    printf("Actual -      %5lld FP        %5lld TN\n\n", cmTrain.FP, cmTrain.TN);
 
-    printf("Testing confusion matrix (actual rows vs predicted columns):\n");
+    printf("Testing confusion matrix, summed over folds (actual rows vs predicted columns):\n");
     printf("              Predicted +   Predicted -\n");
-    printf("Actual +      %5d TP        %5d FN\n", cmTest.TP, cmTest.FN);
-    printf("Actual -      %5d FP        %5d TN\n\n", cmTest.FP, cmTest.TN);
+    printf("Actual +      %5lld TP        %5lld FN\n", cmTest.TP, cmTest.FN);
+    printf("Actual -      %5lld FP        %5lld TN\n\n", cmTest.FP, cmTest.TN);
+}
+
+// Old entry point for the report: 5 folds = 80:20 per fold.
+void nb_train_test_stats(const char *path)
+{
+    nb_kfold_cross_validate(path, 5, 1103ull, 0);
+}
+
+// ---------------------------------------------------------------
+// Symmetry-deduplicated, weighted training sets
+// Rows collapse into (board, label) -> weight, optionally after mapping
+// each board to its canonical symmetric variant. There are only 3^9
+// boards, so the tables are dense and fixed-size however many rows are
+// read, and training/scoring afterwards cost O(unique rows).
+// ---------------------------------------------------------------
+typedef enum { NB_DEDUP_EXACT=0, NB_DEDUP_CANONICAL=1 } NBDedupMode;
+
+typedef struct {
+    int code;          // board code (canonical code in canonical sets)
+    int cls;
+    long long weight;  // raw rows that collapsed into this one
+} NBWeightedRow;
+
+typedef struct {
+    NBWeightedRow *rows;
+    int n;
+    long long rawRows;
+    int canonical;
+} NBWeightedSet;
+
+typedef long long NBDedupTable[2][NB_CODES];
+
+static void nb_dedup_row_exact(void *ctx, long long offset, const int feat[9], int cls)
+{
+    long long (*w)[NB_CODES] = ctx;
+    (void)offset;
+    w[cls][board_code(feat)]++;
 }
 
+static void nb_dedup_row_canonical(void *ctx, long long offset, const int feat[9], int cls)
+{
+    long long (*w)[NB_CODES] = ctx;
+    (void)offset;
+    w[cls][board_canonical_code(feat)]++;
+}
+
+// Streams the files once (in parallel) into *out. Returns the raw row
+// count or -1. Free out->rows when done.
+static long long nb_build_weighted_set(const char *const *paths, int nPaths, int nThreads,
+                                       NBDedupMode mode, NBWeightedSet *out)
+{
+    void *ctxs;
+    int used;
+    memset(out, 0, sizeof *out);
+    long long rows = nb_scan_files(paths, nPaths, nThreads,
+                                   mode == NB_DEDUP_CANONICAL ? nb_dedup_row_canonical
+                                                              : nb_dedup_row_exact,
+                                   sizeof(NBDedupTable), &ctxs, &used);
+    if (rows < 0) { free(ctxs); return -1; }
+
+    long long (*sum)[NB_CODES] = ctxs;   // reduce into thread 0's table
+    for (int t = 1; t < used; t++) {
+        long long (*w)[NB_CODES] = ((NBDedupTable *)ctxs)[t];
+        for (int cls = 0; cls < 2; cls++)
+            for (int c = 0; c < NB_CODES; c++) sum[cls][c] += w[cls][c];
+    }
+    int n = 0;
+    for (int cls = 0; cls < 2; cls++)
+        for (int c = 0; c < NB_CODES; c++) n += (sum[cls][c] != 0);
+    out->rows = malloc(sizeof(NBWeightedRow) * (size_t)(n > 0 ? n : 1));
+    if (!out->rows) { free(ctxs); return -1; }
+    for (int cls = 0; cls < 2; cls++)
+        for (int c = 0; c < NB_CODES; c++)
+            if (sum[cls][c]) {
+                NBWeightedRow r = { c, cls, sum[cls][c] };
+                out->rows[out->n++] = r;
+            }
+    out->rawRows = rows;
+    out->canonical = (mode == NB_DEDUP_CANONICAL);
+    free(ctxs);
+    return rows;
+}
+
+// Adds one weighted row to the counts; with augment, all 8 symmetric
+// variants are added on the fly instead of being stored as rows.
+static void nb_add_weighted_row(NBModel *m, const NBWeightedRow *r, int augment)
+{
+    int feat[9];
+    nb_decode_board(r->code, feat);
+    int variants = augment ? 8 : 1;
+    for (int k = 0; k < variants; k++) {
+        m->classCount[r->cls] += r->weight;
+        for (int i = 0; i < 9; i++)
+            m->counts[r->cls][i][feat[nbSym[k][i]]] += r->weight;
+    }
+    m->totalRows = m->classCount[0] + m->classCount[1];
+}
+
+// Trains the game model from deduplicated (and optionally augmented)
+// rows. Returns the raw row count or -1.
+long long nb_train_dedup(const char *const *paths, int nPaths, int nThreads,
+                         int canonical, int augment)
+{
+    NBWeightedSet set;
+    long long rows = nb_build_weighted_set(paths, nPaths, nThreads,
+                                           canonical ? NB_DEDUP_CANONICAL : NB_DEDUP_EXACT, &set);
+    if (rows < 0) return -1;
+    NBModel m = {0};            // replaces the model, never adds to it
+    for (int i = 0; i < set.n; i++) nb_add_weighted_row(&m, &set.rows[i], augment);
+    m.trained = 1;
+    // an augmented model is already symmetric, no need to canonicalize queries
+    m.canonical = set.canonical && !augment;
+    nb = m;
+    nbLogDirty = 1;
+    free(set.rows);
+    return rows;
+}
 
+// Prints raw vs unique row counts and a weighted k-fold evaluation
+// that only scores each unique (board, label) once per fold.
+// Duplicates share a fold, so copies of a test row never leak into
+// its training data.
+void nb_dedup_report(const char *const *paths, int nPaths, int nThreads,
+                     int canonical, int augment, int k, unsigned long long seed)
+{
+    if (k < 2) k = 2;
+    if (k > NB_MAX_FOLDS) k = NB_MAX_FOLDS;
 
+    NBWeightedSet set;
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    long long rows = nb_build_weighted_set(paths, nPaths, nThreads,
+                                           canonical ? NB_DEDUP_CANONICAL : NB_DEDUP_EXACT, &set);
+    Uint64 t1 = SDL_GetPerformanceCounter();
+    if (rows < 0) {
+        fprintf(stderr, "[NB] Error opening dataset.\n");
+        return;
+    }
+    if (set.n == 0) {
+        printf("[NB] Dataset empty.\n");
+        free(set.rows);
+        return;
+    }
+
+    ConfusionMatrix cmTrain = {0}, cmTest = {0};
+    for (int f = 0; f < k; f++) {
+        NBModel m = {0};
+        for (int i = 0; i < set.n; i++)
+            if (nb_fold_of(seed, set.rows[i].code * 2 + set.rows[i].cls, k) != f)
+                nb_add_weighted_row(&m, &set.rows[i], augment);
+        NBLogTable lt;
+        nb_build_log_table(&m, &lt);
+        for (int i = 0; i < set.n; i++) {
+            int feat[9];
+            nb_decode_board(set.rows[i].code, feat);
+            int inTest = (nb_fold_of(seed, set.rows[i].code * 2 + set.rows[i].cls, k) == f);
+            cm_add(inTest ? &cmTest : &cmTrain, set.rows[i].cls,
+                   nb_log_table_predict(&lt, feat), set.rows[i].weight);
+        }
+    }
+    Uint64 t2 = SDL_GetPerformanceCounter();
+    double freq = (double)SDL_GetPerformanceFrequency();
+
+    double trainTotal = (double)cmTrain.TP + cmTrain.TN + cmTrain.FP + cmTrain.FN;
+    double testTotal  = (double)cmTest.TP + cmTest.TN + cmTest.FP + cmTest.FN;
+    double trainAcc = (trainTotal > 0) ? 100.0 * (cmTrain.TP + cmTrain.TN) / trainTotal : 0.0;
+    double testAcc  = (testTotal  > 0) ? 100.0 * (cmTest.TP + cmTest.TN) / testTotal  : 0.0;
+
+    printf("Naive Bayes on deduplicated rows (%s%s), %d file(s)\n",
+           canonical ? "canonical under 8 symmetries" : "exact duplicates",
+           augment ? ", augmented with all symmetric variants" : "", nPaths);
+    printf("Raw rows: %lld  ->  unique weighted rows: %d  (%.1fx smaller)\n",
+           rows, set.n, (double)rows / set.n);
+    printf("Dedup pass %.3f s, %d-fold evaluation on unique rows %.4f s\n\n",
+           (t1 - t0) / freq, k, (t2 - t1) / freq);
+    printf("Training accuracy   = %.2f%%  (error = %.2f%%)\n", trainAcc, 100.0 - trainAcc);
+    printf("Testing  accuracy   = %.2f%%  (error = %.2f%%)  (weighted by duplicates)\n",
+           testAcc, 100.0 - testAcc);
+    free(set.rows);
+}
@@ -0,0 +1,263 @@
+// analysis.c — post-game analysis against perfect play
+// After a game, a worker thread looks up every move in a solved table
+// (the perfect-play value of all 3^9 boards for either side to move)
+// and marks moves that threw away a win or a draw. Results are cached
+// per game; playbackScreen only reads the cache, so it never waits, and
+// an SDL_USEREVENT tells it a new result is in.
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// This enum must match the one in main.c
+typedef enum { EMPTY=0, X=1, O=2 } Cell;
+
+// Zone profiler (trace.c)
+extern SDL_atomic_t traceOn;
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+void trace_thread_name(const char *name);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
+
+#define AN_CODES      19683   // 3^9 boards
+#define AN_QUEUE      16      // pending games; the oldest is dropped when full
+#define AN_CACHE      32      // analysed games kept
+
+// Value of a board for the side to move: 1 win, 0 draw, -1 loss.
+// solved[side-1][code], UNSOLVED until computed.
+#define UNSOLVED 2
+static signed char solved[2][AN_CODES];
+static int solvedReady = 0;   // only touched by the worker
+
+typedef struct {
+    unsigned gameId;
+    int n;
+    int squares[9];
+    Cell pieces[9];
+} AnalysisJob;
+
+typedef struct {
+    unsigned gameId;          // 0 = empty slot
+    unsigned lastUse;
+    int n;
+    signed char before[9];    // mover's value before / after move i
+    signed char after[9];
+    int squares[9];
+    Cell pieces[9];
+} AnalysisResult;
+
+static SDL_Thread *worker = NULL;
+static SDL_mutex *lock = NULL;
+static SDL_cond *wake = NULL;
+static int stopping = 0;
+static AnalysisJob queue[AN_QUEUE];
+static int queueHead = 0, queueCount = 0;
+static AnalysisResult cache[AN_CACHE];
+static unsigned useClock = 0;
+
+static int an_code(const Cell b[9])
+{
+    int code = 0;
+    for (int i = 8; i >= 0; i--) code = code * 3 + b[i];
+    return code;
+}
+
+static int an_winner(const Cell b[9])
+{
+    static const int lines[8][3] = {
+        {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6}
+    };
+    for (int i = 0; i < 8; ++i) {
+        Cell v = b[lines[i][0]];
+        if (v != EMPTY && v == b[lines[i][1]] && v == b[lines[i][2]]) return v;
+    }
+    return 0;
+}
+
+// Negamax over the whole game tree, memoised in solved[]
+static int an_solve(Cell b[9], Cell side)
+{
+    int code = an_code(b);
+    signed char *v = &solved[side - 1][code];
+    if (*v != UNSOLVED) return *v;
+
+    int w = an_winner(b), best = -2, moves = 0;
+    if (w) {
+        best = (w == (int)side) ? 1 : -1;
+    } else {
+        Cell other = (side == X) ? O : X;
+        for (int i = 0; i < 9 && best < 1; ++i) {
+            if (b[i] != EMPTY) continue;
+            moves++;
+            b[i] = side;
+            int s = -an_solve(b, other);
+            b[i] = EMPTY;
+            if (s > best) best = s;
+        }
+        if (!moves) best = 0;      // full board, no winner
+    }
+    *v = (signed char)best;
+    return best;
+}
+
+static void an_build_table(void)
+{
+    Cell b[9] = {EMPTY};
+    memset(solved, UNSOLVED, sizeof solved);
+    an_solve(b, X);
+    an_solve(b, O);
+    solvedReady = 1;
+}
+
+static AnalysisResult *an_find(unsigned gameId)
+{
+    for (int i = 0; i < AN_CACHE; ++i)
+        if (cache[i].gameId == gameId) return &cache[i];
+    return NULL;
+}
+
+// Analyses one game (worker thread, no lock held)
+static void an_run(const AnalysisJob *job, AnalysisResult *r)
+{
+    Cell b[9] = {EMPTY};
+    if (!solvedReady) an_build_table();
+    r->gameId = job->gameId;
+    r->n = job->n;
+    for (int i = 0; i < job->n; ++i) {
+        Cell side = job->pieces[i], other = (side == X) ? O : X;
+        r->before[i] = (signed char)an_solve(b, side);
+        b[job->squares[i]] = side;
+        r->after[i] = (signed char)-an_solve(b, other);
+        r->squares[i] = job->squares[i];
+        r->pieces[i] = side;
+    }
+}
+
+static int an_worker(void *unused)
+{
+    (void)unused;
+    trace_thread_name("analysis");
+    SDL_LockMutex(lock);
+    for (;;) {
+        while (!stopping && queueCount == 0) SDL_CondWait(wake, lock);
+        if (stopping) break;
+        AnalysisJob job = queue[queueHead];
+        queueHead = (queueHead + 1) % AN_QUEUE;
+        queueCount--;
+        SDL_UnlockMutex(lock);
+
+        AnalysisResult r;
+        TRACE_BEGIN("analysis", "engine");
+        an_run(&job, &r);
+        TRACE_END();
+
+        SDL_LockMutex(lock);
+        AnalysisResult *slot = an_find(r.gameId);
+        if (!slot) {                          // replace the least recently used
+            slot = &cache[0];
+            for (int i = 1; i < AN_CACHE; ++i)
+                if (cache[i].lastUse < slot->lastUse) slot = &cache[i];
+        }
+        r.lastUse = ++useClock;
+        *slot = r;
+
+        // the playback screen sleeps until an event: wake it to show this
+        SDL_Event ev;
+        memset(&ev, 0, sizeof ev);
+        ev.type = SDL_USEREVENT;
+        SDL_PushEvent(&ev);
+    }
+    SDL_UnlockMutex(lock);
+    return 0;
+}
+
+// Queues a finished game for analysis (returns immediately). Games
+// that are cached or already queued are skipped, and so are ones that
+// aren't a legal sequence (a torn or corrupt games.log record).
+void analysis_request(unsigned gameId, const int squares[], const Cell pieces[], int n)
+{
+    int used[9] = {0};
+    if (gameId == 0 || n < 0 || n > 9) return;
+    for (int i = 0; i < n; ++i) {
+        if (squares[i] < 0 || squares[i] > 8 || used[squares[i]] ||
+            (pieces[i] != X && pieces[i] != O)) return;
+        used[squares[i]] = 1;
+    }
+    if (!lock) {
+        lock = SDL_CreateMutex();
+        wake = SDL_CreateCond();
+        if (!lock || !wake) return;
+    }
+    SDL_LockMutex(lock);
+    if (!worker && !stopping) worker = SDL_CreateThread(an_worker, "analysis", NULL);
+    int known = (an_find(gameId) != NULL);
+    for (int i = 0; i < queueCount && !known; ++i)
+        known = (queue[(queueHead + i) % AN_QUEUE].gameId == gameId);
+    if (worker && !known) {
+        if (queueCount == AN_QUEUE) {         // drop the oldest request
+            queueHead = (queueHead + 1) % AN_QUEUE;
+            queueCount--;
+        }
+        AnalysisJob *job = &queue[(queueHead + queueCount) % AN_QUEUE];
+        job->gameId = gameId;
+        job->n = n;
+        memcpy(job->squares, squares, sizeof(int) * (size_t)n);
+        memcpy(job->pieces, pieces, sizeof(Cell) * (size_t)n);
+        queueCount++;
+        SDL_CondSignal(wake);
+    }
+    SDL_UnlockMutex(lock);
+}
+
+// Describes move 'step' (1-based; 0 = the starting position) of an
+// analysed game into buf. Returns -1 if the analysis isn't ready yet,
+// 0 for a move that keeps the best result, 1 for a missed win and
+// 2 for a blunder (a draw or win thrown into a loss).
+int analysis_annotation(unsigned gameId, int step, char *buf, int size)
+{
+    static const char *const valueNames[3] = { "loss", "draw", "win" };
+    int verdict = -1;
+    if (!lock) return -1;
+
+    SDL_LockMutex(lock);
+    AnalysisResult *r = an_find(gameId);
+    if (r && step >= 0 && step <= r->n) {
+        r->lastUse = ++useClock;
+        if (step == 0) {
+            if (r->n > 0)
+                snprintf(buf, (size_t)size, "Perfect play: %s for %c",
+                         valueNames[r->before[0] + 1], r->pieces[0] == X ? 'X' : 'O');
+            else
+                snprintf(buf, (size_t)size, "No moves");
+            verdict = 0;
+        } else {
+            int i = step - 1, b = r->before[i], a = r->after[i];
+            char mover = (r->pieces[i] == X) ? 'X' : 'O';
+            char col = (char)('a' + r->squares[i] % 3), row = (char)('1' + r->squares[i] / 3);
+            if (a >= b) {
+                snprintf(buf, (size_t)size, "%c %c%c: best move (%s)", mover, col, row, valueNames[b + 1]);
+                verdict = 0;
+            } else if (b == 1 && a == 0) {
+                snprintf(buf, (size_t)size, "%c %c%c: missed win (now a draw)", mover, col, row);
+                verdict = 1;
+            } else {
+                snprintf(buf, (size_t)size, "%c %c%c: blunder (%s -> loss)", mover, col, row, valueNames[b + 1]);
+                verdict = 2;
+            }
+        }
+    }
+    SDL_UnlockMutex(lock);
+    return verdict;
+}
+
+// Stops the worker (pending requests are dropped).
+void analysis_shutdown(void)
+{
+    if (!lock) return;
+    SDL_LockMutex(lock);
+    stopping = 1;
+    SDL_CondSignal(wake);
+    SDL_UnlockMutex(lock);
+    if (worker) SDL_WaitThread(worker, NULL);
+    worker = NULL;
+}
@@ -0,0 +1,91 @@
+// anim.c — timeline of tweens for the game screen
+// Each track is a start time and a duration (a delay is just a later
+// start); anim_value() gives its eased progress. Nothing here draws or
+// sleeps: each frame the main loop calls anim_frame() to learn whether
+// anything moved, draws from the values, and sleeps for anim_next_due().
+// A finished track stays at 1 until it is stopped.
+#include <SDL2/SDL.h>
+
+#define ANIM_TRACKS 16
+
+enum { EASE_LINEAR, EASE_OUT, EASE_IN_OUT };   // must match the one in main.c
+
+typedef struct {
+    int on;
+    int settled;                // its final frame has been asked for
+    int ease;
+    Uint32 start, duration;     // ms (SDL_GetTicks)
+} Track;
+
+static Track tracks[ANIM_TRACKS];
+
+void anim_start(int id, Uint32 now, Uint32 delay, Uint32 duration, int ease)
+{
+    if (id < 0 || id >= ANIM_TRACKS) return;
+    tracks[id].on = 1;
+    tracks[id].settled = 0;
+    tracks[id].ease = ease;
+    tracks[id].start = now + delay;
+    tracks[id].duration = duration ? duration : 1;
+}
+
+void anim_stop(int id)
+{
+    if (id >= 0 && id < ANIM_TRACKS) tracks[id].on = 0;
+}
+
+void anim_stop_all(void)
+{
+    for (int i = 0; i < ANIM_TRACKS; ++i) tracks[i].on = 0;
+}
+
+// Eased progress 0..1 of track id at 'now'; -1 if it isn't running or
+// hasn't started yet.
+float anim_value(int id, Uint32 now)
+{
+    if (id < 0 || id >= ANIM_TRACKS || !tracks[id].on) return -1.0f;
+    const Track *t = &tracks[id];
+    if ((Sint32)(now - t->start) < 0) return -1.0f;
+    float x = (float)(now - t->start) / (float)t->duration;
+    if (x >= 1.0f) return 1.0f;
+    switch (t->ease) {
+    case EASE_OUT:    { float u = 1.0f - x; return 1.0f - u*u*u; }
+    case EASE_IN_OUT: return x < 0.5f ? 4.0f*x*x*x : 1.0f - 4.0f*(1.0f - x)*(1.0f - x)*(1.0f - x);
+    default:               return x;
+    }
+}
+
+// 1 once track id has run its full duration.
+int anim_done(int id, Uint32 now)
+{
+    if (id < 0 || id >= ANIM_TRACKS || !tracks[id].on) return 0;
+    Sint32 elapsed = (Sint32)(now - tracks[id].start);
+    return elapsed >= 0 && (Uint32)elapsed >= tracks[id].duration;
+}
+
+// Call once per frame: 1 if track id has moved since the last call
+// (including the frame where it reaches its end), so it needs drawing.
+int anim_frame(int id, Uint32 now)
+{
+    if (id < 0 || id >= ANIM_TRACKS) return 0;
+    Track *t = &tracks[id];
+    if (!t->on || t->settled || (Sint32)(now - t->start) < 0) return 0;
+    if (anim_done(id, now)) t->settled = 1;
+    return 1;
+}
+
+// How long the caller may sleep before a track needs a new frame:
+// 0 if something is moving, the time until the next track starts, or
+// -1 if no track will change.
+int anim_next_due(Uint32 now)
+{
+    int due = -1;
+    for (int i = 0; i < ANIM_TRACKS; ++i) {
+        const Track *t = &tracks[i];
+        if (!t->on || t->settled) continue;
+        Sint32 untilStart = (Sint32)(t->start - now);
+        if (untilStart <= 0) return 0;
+        if (due < 0 || untilStart < due) due = (int)untilStart;
+    }
+    return due;
+}
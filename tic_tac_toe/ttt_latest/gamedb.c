@@ -0,0 +1,450 @@
+// gamedb.c — compact game encoding and a columnar game database
+// A whole game is one 24-bit code: the order the squares were played
+// in, ranked as a partial permutation of the 9 squares (< 9! = 362880,
+// 19 bits), plus the number of moves (4 bits) and who moved first (1 bit).
+// Pieces always alternate, so nothing else is needed.
+//
+// games.tdb is built from games.log and stored column by column:
+//   header (32 bytes)
+//   bitmap index: one bit per game for every outcome / bot / difficulty /
+//                 length value (uint64 words)
+//   code column (3 bytes per game), then outcome, bot, difficulty and
+//   length columns (1 byte per game each)
+// Queries AND the bitmaps of the filter and only touch the codes of
+// games that pass, so scans cost little more than reading the index.
+// Everything is little-endian (x86 / x64).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Read-only file mapping (mapfile.c)
+typedef struct MappedFile MappedFile;
+MappedFile *mapfile_open(const char *path);
+const unsigned char *mapfile_data(const MappedFile *m);
+size_t mapfile_size(const MappedFile *m);
+void mapfile_close(MappedFile *m);
+
+// ---------------------------------------------------------------
+// Game codes
+// ---------------------------------------------------------------
+#define GAME_RANK_BITS  19
+#define GAME_LEN_SHIFT  19
+#define GAME_FIRST_BIT  23
+
+// Packs a game (squares r*3+c in play order, first piece X=1 / O=2).
+// Returns 0xFFFFFFFF if the squares are not a valid distinct sequence.
+uint32_t game_encode(const int squares[], int n, int firstPiece)
+{
+    int used[9] = {0};
+    uint32_t rank = 0;
+    if (n < 0 || n > 9) return 0xFFFFFFFFu;
+    for (int i = 0; i < n; ++i) {
+        int sq = squares[i];
+        if (sq < 0 || sq > 8 || used[sq]) return 0xFFFFFFFFu;
+        int digit = 0;                       // position among the unused squares
+        for (int j = 0; j < sq; ++j) if (!used[j]) digit++;
+        used[sq] = 1;
+        rank = rank * (uint32_t)(9 - i) + (uint32_t)digit;
+    }
+    return rank | ((uint32_t)n << GAME_LEN_SHIFT) | ((uint32_t)(firstPiece == 2) << GAME_FIRST_BIT);
+}
+
+// Unpacks a game code. Returns the number of moves; pieces[i] gets
+// X=1 / O=2 for each move (pieces may be NULL).
+int game_decode(uint32_t code, int squares[9], int pieces[9])
+{
+    int n = (int)((code >> GAME_LEN_SHIFT) & 0xF);
+    int first = (code >> GAME_FIRST_BIT) & 1 ? 2 : 1;
+    uint32_t rank = code & ((1u << GAME_RANK_BITS) - 1);
+    int digits[9];
+    if (n > 9) n = 9;
+
+    for (int i = n - 1; i >= 0; --i) {
+        digits[i] = (int)(rank % (uint32_t)(9 - i));
+        rank /= (uint32_t)(9 - i);
+    }
+    int used[9] = {0};
+    for (int i = 0; i < n; ++i) {
+        int k = digits[i], sq;
+        for (sq = 0; sq < 8; ++sq)           // k-th unused square
+            if (!used[sq] && k-- == 0) break;
+        used[sq] = 1;
+        squares[i] = sq;
+        if (pieces) pieces[i] = (i % 2 == 0) ? first : 3 - first;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------
+// Database file
+// ---------------------------------------------------------------
+#define GDB_HEADER_SIZE 32
+#define GDB_VERSION     1
+
+// bitmap slots: outcome 0..2, bot 0..2, difficulty 0..3, length 0..9
+enum { GDB_BM_OUTCOME = 0, GDB_BM_BOT = 3, GDB_BM_DIFF = 6, GDB_BM_LEN = 10, GDB_BITMAPS = 20 };
+
+enum { BOT_NONE = 0, BOT_NB = 1, BOT_MINIMAX = 2 };   // who the human played against
+#define DIFF_NONE 3                                     // multiplayer
+
+static const char gdbMagic[8] = { 'T','T','T','G','D','B','0','1' };
+
+typedef struct {
+    MappedFile *map;
+    long long count;
+    long long words;                 // uint64 words per bitmap
+    const uint64_t *bitmaps;         // GDB_BITMAPS * words
+    const unsigned char *codes;      // 3 bytes per game
+    const unsigned char *outcome, *bot, *difficulty, *length;
+} GameDB;
+
+// Filter for gamedb_scan: -1 means "any"
+typedef struct {
+    int outcome;                     // 0 draw, 1 X won, 2 O won
+    int bot;                         // BOT_*
+    int difficulty;                  // 0..2, DIFF_NONE for multiplayer
+    int minLen, maxLen;              // moves played
+} GameFilter;
+
+typedef void (*GameVisitFn)(long long index, uint32_t code, void *ctx);
+
+static int gdb_popcount(uint64_t w)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(w);
+#else
+    int n = 0;
+    for (; w; w &= w - 1) n++;
+    return n;
+#endif
+}
+
+static int gdb_lowest_bit(uint64_t w)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+#endif
+}
+
+static uint32_t gdb_code_at(const GameDB *db, long long i)
+{
+    const unsigned char *p = db->codes + i * 3;
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+}
+
+static GameDB *gamedb_open(const char *path)
+{
+    MappedFile *map = mapfile_open(path);
+    if (!map) return NULL;
+    const unsigned char *p = mapfile_data(map);
+    size_t size = mapfile_size(map);
+    uint32_t version = 0;
+    uint64_t count = 0;
+    if (size < GDB_HEADER_SIZE || memcmp(p, gdbMagic, sizeof gdbMagic) != 0) {
+        mapfile_close(map);
+        return NULL;
+    }
+    memcpy(&version, p + 8, sizeof version);
+    memcpy(&count, p + 16, sizeof count);
+    long long words = (long long)((count + 63) / 64);
+    unsigned long long need = GDB_HEADER_SIZE + (unsigned long long)words * 8 * GDB_BITMAPS + count * 7;
+    if (version != GDB_VERSION || need > size) {
+        mapfile_close(map);
+        return NULL;
+    }
+
+    GameDB *db = calloc(1, sizeof *db);
+    if (!db) { mapfile_close(map); return NULL; }
+    db->map = map;
+    db->count = (long long)count;
+    db->words = words;
+    db->bitmaps = (const uint64_t *)(p + GDB_HEADER_SIZE);
+    db->codes = (const unsigned char *)(db->bitmaps + words * GDB_BITMAPS);
+    db->outcome = db->codes + count * 3;
+    db->bot = db->outcome + count;
+    db->difficulty = db->bot + count;
+    db->length = db->difficulty + count;
+    return db;
+}
+
+static void gamedb_close(GameDB *db)
+{
+    if (!db) return;
+    mapfile_close(db->map);
+    free(db);
+}
+
+// Mask of games in word w that pass the filter (bitmaps only)
+static uint64_t gdb_match_word(const GameDB *db, const GameFilter *f, long long w)
+{
+    const uint64_t *bm = db->bitmaps;
+    long long W = db->words;
+    uint64_t m = ~0ull;
+    if (w == W - 1 && db->count % 64) m = (1ull << (db->count % 64)) - 1;
+
+    if (f->outcome >= 0)    m &= bm[(GDB_BM_OUTCOME + f->outcome) * W + w];
+    if (f->bot >= 0)        m &= bm[(GDB_BM_BOT + f->bot) * W + w];
+    if (f->difficulty >= 0) m &= bm[(GDB_BM_DIFF + f->difficulty) * W + w];
+    if (f->minLen > 0 || f->maxLen < 9) {
+        uint64_t lenMask = 0;
+        for (int len = f->minLen; len <= f->maxLen; ++len)
+            lenMask |= bm[(GDB_BM_LEN + len) * W + w];
+        m &= lenMask;
+    }
+    return m;
+}
+
+// Calls visit for every game passing the filter, in game order.
+// Games that fail are never read. Returns the number of matches.
+static long long gamedb_scan(const GameDB *db, const GameFilter *f, GameVisitFn visit, void *ctx)
+{
+    long long matches = 0;
+    for (long long w = 0; w < db->words; ++w) {
+        uint64_t m = gdb_match_word(db, f, w);
+        if (!visit) { matches += gdb_popcount(m); continue; }
+        while (m) {
+            long long i = w * 64 + gdb_lowest_bit(m);
+            visit(i, gdb_code_at(db, i), ctx);
+            m &= m - 1;
+            matches++;
+        }
+    }
+    return matches;
+}
+
+// Counts matches per value of one bitmap group without visiting games
+static void gamedb_count_by(const GameDB *db, const GameFilter *f, int group, int values, long long out[])
+{
+    for (int v = 0; v < values; ++v) out[v] = 0;
+    for (long long w = 0; w < db->words; ++w) {
+        uint64_t m = gdb_match_word(db, f, w);
+        if (!m) continue;
+        for (int v = 0; v < values; ++v)
+            out[v] += gdb_popcount(m & db->bitmaps[(group + v) * db->words + w]);
+    }
+}
+
+// ---------------------------------------------------------------
+// Building games.tdb from games.log (record layout: see playback.c)
+// ---------------------------------------------------------------
+#define GAMELOG_HEADER_SIZE 16
+#define GAMELOG_RECORD_SIZE 24
+
+static void gdb_set_bit(uint64_t *bm, long long words, int slot, long long i)
+{
+    bm[slot * words + i / 64] |= 1ull << (i % 64);
+}
+
+// Returns the number of games written, or -1 on error.
+static long long gamedb_build(const char *logPath, const char *dbPath)
+{
+    MappedFile *log = mapfile_open(logPath);
+    if (!log) {
+        fprintf(stderr, "[gamedb] Cannot read '%s'.\n", logPath);
+        return -1;
+    }
+    const unsigned char *p = mapfile_data(log);
+    size_t size = mapfile_size(log);
+    if (size < GAMELOG_HEADER_SIZE || memcmp(p, "TTTGAMES", 8) != 0) {
+        fprintf(stderr, "[gamedb] '%s' is not a game log.\n", logPath);
+        mapfile_close(log);
+        return -1;
+    }
+    long long total = (long long)((size - GAMELOG_HEADER_SIZE) / GAMELOG_RECORD_SIZE);
+    long long words = (total + 63) / 64;
+
+    uint64_t *bm = calloc((size_t)(words * GDB_BITMAPS) + 1, sizeof *bm);
+    unsigned char *cols = malloc((size_t)total * 7 + 1);
+    if (!bm || !cols) {
+        fprintf(stderr, "[gamedb] Out of memory.\n");
+        free(bm); free(cols); mapfile_close(log);
+        return -1;
+    }
+
+    // first pass writes the columns compactly; skipped games leave no gap
+    long long n = 0, skipped = 0;
+    unsigned char *codes = cols, *outc = cols + total * 3, *bot = outc + total,
+                  *diff = bot + total, *len = diff + total;
+    for (long long r = 0; r < total; ++r) {
+        const unsigned char *rec = p + GAMELOG_HEADER_SIZE + r * GAMELOG_RECORD_SIZE;
+        int moves = rec[8], winner = rec[9], mode = rec[10], d = rec[11];
+        int squares[9], ok = (moves <= 9 && winner <= 2);
+        int first = ok && moves ? (rec[12] >> 4) : 1;
+        for (int i = 0; ok && i < moves; ++i) {
+            squares[i] = rec[12 + i] & 0x0F;
+            ok = ((rec[12 + i] >> 4) == ((i % 2 == 0) ? first : 3 - first));
+        }
+        uint32_t code = ok ? game_encode(squares, moves, first) : 0xFFFFFFFFu;
+        if (code == 0xFFFFFFFFu) { skipped++; continue; }
+
+        int b = (mode != 2) ? BOT_NONE : (d == 0 ? BOT_NB : BOT_MINIMAX);
+        int dv = (mode != 2 || d > 2) ? DIFF_NONE : d;
+        codes[n * 3]     = (unsigned char)(code & 0xFF);
+        codes[n * 3 + 1] = (unsigned char)((code >> 8) & 0xFF);
+        codes[n * 3 + 2] = (unsigned char)(code >> 16);
+        outc[n] = (unsigned char)winner;
+        bot[n]  = (unsigned char)b;
+        diff[n] = (unsigned char)dv;
+        len[n]  = (unsigned char)moves;
+        gdb_set_bit(bm, words, GDB_BM_OUTCOME + winner, n);
+        gdb_set_bit(bm, words, GDB_BM_BOT + b, n);
+        gdb_set_bit(bm, words, GDB_BM_DIFF + dv, n);
+        gdb_set_bit(bm, words, GDB_BM_LEN + moves, n);
+        n++;
+    }
+    mapfile_close(log);
+
+    // if games were skipped the bitmaps are wider than needed; the
+    // file uses the real count, so repack them
+    long long outWords = (n + 63) / 64;
+    if (outWords != words)
+        for (int s = 1; s < GDB_BITMAPS; ++s)
+            memmove(bm + s * outWords, bm + s * words, (size_t)outWords * sizeof *bm);
+
+    char tmp[1024];
+    snprintf(tmp, sizeof tmp, "%s.tmp", dbPath);
+    FILE *f = fopen(tmp, "wb");
+    int failed = (f == NULL);
+    if (f) {
+        unsigned char header[GDB_HEADER_SIZE] = {0};
+        uint32_t version = GDB_VERSION;
+        uint64_t count = (uint64_t)n;
+        memcpy(header, gdbMagic, sizeof gdbMagic);
+        memcpy(header + 8, &version, sizeof version);
+        memcpy(header + 16, &count, sizeof count);
+        failed |= fwrite(header, 1, sizeof header, f) != sizeof header;
+        failed |= fwrite(bm, sizeof *bm, (size_t)(outWords * GDB_BITMAPS), f) != (size_t)(outWords * GDB_BITMAPS);
+        failed |= fwrite(codes, 3, (size_t)n, f) != (size_t)n;
+        failed |= fwrite(outc, 1, (size_t)n, f) != (size_t)n;
+        failed |= fwrite(bot,  1, (size_t)n, f) != (size_t)n;
+        failed |= fwrite(diff, 1, (size_t)n, f) != (size_t)n;
+        failed |= fwrite(len,  1, (size_t)n, f) != (size_t)n;
+        failed |= fclose(f) != 0;
+    }
+    free(bm);
+    free(cols);
+    remove(dbPath);   // rename() won't replace an existing file on Windows
+    if (failed || rename(tmp, dbPath) != 0) {
+        fprintf(stderr, "[gamedb] Could not write '%s'.\n", dbPath);
+        remove(tmp);
+        return -1;
+    }
+    if (skipped) fprintf(stderr, "[gamedb] Skipped %lld malformed game(s).\n", skipped);
+    return n;
+}
+
+// ---------------------------------------------------------------
+// Command-line tool
+// ---------------------------------------------------------------
+typedef struct {
+    long long printed, limit;
+} GdbPrintCtx;
+
+static void gdb_print_game(long long index, uint32_t code, void *ctx)
+{
+    GdbPrintCtx *pc = ctx;
+    if (pc->printed >= pc->limit) return;
+    int squares[9], pieces[9];
+    int n = game_decode(code, squares, pieces);
+    printf("game %lld:", index + 1);
+    for (int i = 0; i < n; ++i)
+        printf(" %c%d", pieces[i] == 1 ? 'X' : 'O', squares[i]);
+    printf("\n");
+    pc->printed++;
+}
+
+// Index of s in names[], or its value if it is all digits; 'count' (out
+// of range, so the caller rejects it) for anything else.
+static int gdb_value(const char *s, const char *const names[], int count)
+{
+    for (int i = 0; i < count; ++i)
+        if (strcmp(s, names[i]) == 0) return i;
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (s[0] < '0' || s[0] > '9' || *end != '\0' || v >= count) return count;
+    return (int)v;
+}
+
+// Move count 0..9 given as digits only, or -1.
+static int gdb_length(const char *s)
+{
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (s[0] < '0' || s[0] > '9' || *end != '\0' || v > 9) return -1;
+    return (int)v;
+}
+
+static void gdb_usage(const char *exe)
+{
+    fprintf(stderr,
+            "usage: %s --gamedb-build [games.log] [games.tdb]\n"
+            "       %s --gamedb-query [games.tdb] [--outcome draw|x|o] [--bot none|nb|minimax]\n"
+            "          [--difficulty easy|medium|hard|none] [--length N] [--min-length N]\n"
+            "          [--max-length N] [--print N]\n",
+            exe, exe);
+}
+
+// ttt.exe --gamedb-build / --gamedb-query (see gdb_usage). Returns the exit code.
+int gamedb_main(int argc, char *argv[])
+{
+    static const char *const outcomeNames[] = { "draw", "x", "o" };
+    static const char *const botNames[]     = { "none", "nb", "minimax" };
+    static const char *const diffNames[]    = { "easy", "medium", "hard", "none" };
+
+    if (strcmp(argv[1], "--gamedb-build") == 0) {
+        const char *logPath = (argc > 2) ? argv[2] : "games.log";
+        const char *dbPath  = (argc > 3) ? argv[3] : "games.tdb";
+        long long n = gamedb_build(logPath, dbPath);
+        if (n < 0) return 1;
+        printf("Game DB: %lld games -> '%s'\n", n, dbPath);
+        return 0;
+    }
+
+    const char *dbPath = "games.tdb";
+    GameFilter f = { -1, -1, -1, 0, 9 };
+    GdbPrintCtx pc = { 0, 0 };
+    int i = 2;
+    if (i < argc && strncmp(argv[i], "--", 2) != 0) dbPath = argv[i++];
+    for (; i + 1 < argc; i += 2) {
+        const char *opt = argv[i], *val = argv[i + 1];
+        if      (strcmp(opt, "--outcome") == 0)    f.outcome = gdb_value(val, outcomeNames, 3);
+        else if (strcmp(opt, "--bot") == 0)        f.bot = gdb_value(val, botNames, 3);
+        else if (strcmp(opt, "--difficulty") == 0) f.difficulty = gdb_value(val, diffNames, 4);
+        else if (strcmp(opt, "--length") == 0)     f.minLen = f.maxLen = gdb_length(val);
+        else if (strcmp(opt, "--min-length") == 0) f.minLen = gdb_length(val);
+        else if (strcmp(opt, "--max-length") == 0) f.maxLen = gdb_length(val);
+        else if (strcmp(opt, "--print") == 0)      pc.limit = atoll(val);
+        else { gdb_usage(argv[0]); return 1; }
+    }
+    if (i < argc || f.outcome > 2 || f.bot > 2 || f.difficulty > 3 || f.minLen < 0 || f.maxLen < 0) {
+        gdb_usage(argv[0]);
+        return 1;
+    }
+
+    GameDB *db = gamedb_open(dbPath);
+    if (!db) {
+        fprintf(stderr, "[gamedb] Cannot open '%s' (build it with --gamedb-build).\n", dbPath);
+        return 1;
+    }
+
+    long long byOutcome[3], byLength[10], matches;
+    gamedb_count_by(db, &f, GDB_BM_OUTCOME, 3, byOutcome);
+    gamedb_count_by(db, &f, GDB_BM_LEN, 10, byLength);
+    if (pc.limit > 0)
+        matches = gamedb_scan(db, &f, gdb_print_game, &pc);
+    else
+        matches = gamedb_scan(db, &f, NULL, NULL);
+
+    long long moves = 0;
+    for (int len = 0; len <= 9; ++len) moves += byLength[len] * len;
+    printf("%lld of %lld games match\n", matches, db->count);
+    printf("X wins %lld, O wins %lld, draws %lld\n", byOutcome[1], byOutcome[2], byOutcome[0]);
+    printf("Average length %.2f moves\n", matches ? (double)moves / (double)matches : 0.0);
+    gamedb_close(db);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// geom.c — batched, antialiased 2D shapes
+// Lines, discs and rounded rectangles are all "boxes": a centre, an axis,
+// half-width/half-height and a corner radius. Each one is tessellated
+// into a shared triangle list with per-vertex colours, and geom_flush()
+// draws the whole list with a single SDL_RenderGeometry call (shapes are
+// untextured, so there is only the one material). Edges are
+// antialiased by the geometry itself: a 1-pixel band whose alpha ramps
+// to 0, so nothing is drawn twice. Shapes are drawn in the order they
+// were added; the flush always blends (SDL_BLENDMODE_BLEND).
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+
+#define GEOM_MAX_SEGS  32        // per quarter circle
+#define GEOM_HALF_PI   1.57079633f
+
+typedef struct {
+    float cx, cy;                // centre
+    float ux, uy;                // unit axis (along the width)
+    float hw, hh;                // half-width, half-height
+    float rad;                   // corner radius, <= min(hw, hh)
+} GeomBox;
+
+static SDL_Vertex *verts = NULL;
+static int *indices = NULL;
+static int nVerts = 0, nIndices = 0;
+static int capVerts = 0, capIndices = 0;
+
+// Makes room for n more vertices and m more indices.
+static int gm_reserve(int n, int m)
+{
+    if (nVerts + n > capVerts) {
+        int cap = capVerts ? capVerts : 1024;
+        while (cap < nVerts + n) cap *= 2;
+        SDL_Vertex *v = realloc(verts, sizeof *v * (size_t)cap);
+        if (!v) return 0;
+        verts = v;
+        capVerts = cap;
+    }
+    if (nIndices + m > capIndices) {
+        int cap = capIndices ? capIndices : 4096;
+        while (cap < nIndices + m) cap *= 2;
+        int *ix = realloc(indices, sizeof *ix * (size_t)cap);
+        if (!ix) return 0;
+        indices = ix;
+        capIndices = cap;
+    }
+    return 1;
+}
+
+static int gm_segments(float radius)
+{
+    int n = 2 + (int)(radius * 0.5f);
+    return n > GEOM_MAX_SEGS ? GEOM_MAX_SEGS : n;
+}
+
+static void gm_vertex(const GeomBox *b, float lx, float ly, SDL_Color c)
+{
+    SDL_Vertex *v = &verts[nVerts++];
+    v->position.x = b->cx + lx * b->ux - ly * b->uy;
+    v->position.y = b->cy + lx * b->uy + ly * b->ux;
+    v->color = c;
+    v->tex_coord.x = v->tex_coord.y = 0.0f;
+}
+
+// Appends the outline of b grown by d (shrunk if d < 0): 4*(segs+1)
+// vertices, four corner arcs in order. Returns the first vertex index.
+static int gm_contour(const GeomBox *b, float d, int segs, SDL_Color c)
+{
+    static const float sx[4] = { 1, -1, -1, 1 }, sy[4] = { 1, 1, -1, -1 };
+    int first = nVerts;
+    float r = b->rad + d;
+    for (int k = 0; k < 4; ++k) {
+        for (int j = 0; j <= segs; ++j) {
+            if (r <= 0.0f) {                // sharp corner
+                float x = b->hw + d, y = b->hh + d;
+                gm_vertex(b, sx[k] * (x > 0 ? x : 0), sy[k] * (y > 0 ? y : 0), c);
+            } else {
+                float a = ((float)k + (float)j / (float)segs) * GEOM_HALF_PI;
+                gm_vertex(b, sx[k] * (b->hw - b->rad) + r * cosf(a),
+                             sy[k] * (b->hh - b->rad) + r * sinf(a), c);
+            }
+        }
+    }
+    return first;
+}
+
+// Triangles between two contours of n vertices each.
+static void gm_strip(int a, int b, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        int j = (i + 1) % n;
+        int *ix = &indices[nIndices];
+        ix[0] = a + i; ix[1] = a + j; ix[2] = b + i;
+        ix[3] = a + j; ix[4] = b + j; ix[5] = b + i;
+        nIndices += 6;
+    }
+}
+
+// Triangles from the box centre to a contour of n vertices.
+static void gm_fan(const GeomBox *b, int a, int n, SDL_Color c)
+{
+    int centre = nVerts;
+    gm_vertex(b, 0, 0, c);
+    for (int i = 0; i < n; ++i) {
+        int *ix = &indices[nIndices];
+        ix[0] = centre; ix[1] = a + i; ix[2] = a + (i + 1) % n;
+        nIndices += 3;
+    }
+}
+
+static void gm_box_fill(GeomBox b, SDL_Color c)
+{
+    if (b.rad > b.hw) b.rad = b.hw;
+    if (b.rad > b.hh) b.rad = b.hh;
+    int segs = b.rad > 0.0f ? gm_segments(b.rad) : 1;
+    int n = 4 * (segs + 1);
+    if (!gm_reserve(2*n + 1, 9*n)) return;
+    SDL_Color clear = c;
+    clear.a = 0;
+    int outer = gm_contour(&b, 0.5f, segs, clear);
+    int inner = gm_contour(&b, -0.5f, segs, c);
+    gm_strip(outer, inner, n);
+    gm_fan(&b, inner, n, c);
+}
+
+static void gm_box_outline(GeomBox b, float width, SDL_Color c)
+{
+    if (b.rad > b.hw) b.rad = b.hw;
+    if (b.rad > b.hh) b.rad = b.hh;
+    int segs = b.rad > 0.0f ? gm_segments(b.rad) : 1;
+    int n = 4 * (segs + 1);
+    if (!gm_reserve(4*n, 18*n)) return;
+    SDL_Color clear = c;
+    clear.a = 0;
+    int outer = gm_contour(&b, 0.5f, segs, clear);
+    int edge = gm_contour(&b, -0.5f, segs, c);
+    gm_strip(outer, edge, n);
+    if (width > 1.0f) {                 // solid core
+        int core = gm_contour(&b, 0.5f - width, segs, c);
+        gm_strip(edge, core, n);
+        edge = core;
+    }
+    int inner = gm_contour(&b, -0.5f - width, segs, clear);
+    gm_strip(edge, inner, n);
+}
+
+// Straight line of the given thickness between two points, square ends
+// (the points are the centres of the end pixels).
+void geom_line(float x1, float y1, float x2, float y2, float thickness, SDL_Color c)
+{
+    float dx = x2 - x1, dy = y2 - y1;
+    float len = sqrtf(dx*dx + dy*dy);
+    if (len == 0.0f) return;
+    GeomBox b = { (x1 + x2) * 0.5f, (y1 + y2) * 0.5f, dx / len, dy / len,
+                  len * 0.5f + 0.5f, thickness * 0.5f, 0.0f };
+    gm_box_fill(b, c);
+}
+
+void geom_disc(float cx, float cy, float r, SDL_Color c)
+{
+    GeomBox b = { cx, cy, 1, 0, r, r, r };
+    gm_box_fill(b, c);
+}
+
+// Ring 'width' wide inside radius r (a disc if width >= r).
+void geom_ring(float cx, float cy, float r, float width, SDL_Color c)
+{
+    GeomBox b = { cx, cy, 1, 0, r, r, r };
+    if (width >= r) gm_box_fill(b, c);
+    else gm_box_outline(b, width, c);
+}
+
+// Filled rounded rectangle covering the pixels of 'r'.
+void geom_rounded_rect(SDL_Rect r, float rad, SDL_Color c)
+{
+    GeomBox b = { r.x + r.w * 0.5f, r.y + r.h * 0.5f, 1, 0, r.w * 0.5f, r.h * 0.5f, rad };
+    gm_box_fill(b, c);
+}
+
+// Border 'width' pixels wide along the inside edge of 'r'.
+void geom_rounded_rect_outline(SDL_Rect r, float rad, float width, SDL_Color c)
+{
+    GeomBox b = { r.x + r.w * 0.5f, r.y + r.h * 0.5f, 1, 0, r.w * 0.5f, r.h * 0.5f, rad };
+    gm_box_outline(b, width, c);
+}
+
+// Draws everything added since the last flush. Returns 1 if it made a
+// draw call, 0 if there was nothing to draw.
+int geom_flush(SDL_Renderer *r)
+{
+    if (nIndices == 0) { nVerts = 0; return 0; }
+    SDL_BlendMode mode;
+    SDL_GetRenderDrawBlendMode(r, &mode);
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(r, NULL, verts, nVerts, indices, nIndices);
+    SDL_SetRenderDrawBlendMode(r, mode);
+    nVerts = nIndices = 0;
+    return 1;
+}
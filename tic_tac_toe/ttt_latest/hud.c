@@ -0,0 +1,188 @@
+// hud.c — performance overlay for the game screen (F3)
+// The bot numbers are the ones botMove() logs to bot_metrics.csv and the
+// latency histograms (latency.c); frame times come from redrawScene().
+// The panel is rasterised into one texture at most every HUD_REFRESH_MS,
+// so while it is up a frame only pays for a single texture copy.
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define HUD_REFRESH_MS 500
+#define LAT_MAX_BOTS   16                 // must match latency.c
+#define HUD_LINES      (4 + LAT_MAX_BOTS) // frame, RSS, text cache, last move + a line per histogram
+#define HUD_LINE_LEN   96
+#define HUD_PAD        6
+
+// This struct must match the one in proc_metrics.c
+typedef struct {
+    long long rssKb, peakRssKb;
+    long long userCpuUs, sysCpuUs;
+    long long volCtxSwitches, involCtxSwitches;
+} ProcMetrics;
+
+int  proc_metrics_sample(ProcMetrics *m);
+int  latency_bot_stats(int i, const char **bot, long long *moves, long long *lastUs, long long *p99Us);
+void textcache_stats(unsigned long long *hitCount, unsigned long long *missCount);
+
+static SDL_Texture *tex = NULL;
+static SDL_Renderer *texOwner = NULL;
+static int texW = 0, texH = 0;
+static Uint32 nextRefresh = 0;
+
+// since the last refresh
+static int frames = 0;
+static double frameMsSum = 0.0, frameMsMax = 0.0;
+static Uint32 periodStart = 0;
+static unsigned long long prevHits = 0, prevMisses = 0;
+
+// most recent bot move
+static char lastBot[24];
+static double lastMicros = 0.0;
+static long long lastNodes = -1;
+
+// One presented frame that took 'ms' to draw.
+void hud_frame(double ms)
+{
+    frames++;
+    frameMsSum += ms;
+    if (ms > frameMsMax) frameMsMax = ms;
+}
+
+// One bot move: the same time and node count that go to bot_metrics.csv
+// (nodes -1 = the bot doesn't search).
+void hud_bot_move(const char *bot, double micros, long long nodes)
+{
+    snprintf(lastBot, sizeof lastBot, "%s", bot);
+    lastMicros = micros;
+    lastNodes = nodes;
+}
+
+static void hud_time(char *buf, size_t size, double us)
+{
+    if (us < 1000.0)         snprintf(buf, size, "%.0f us", us);
+    else if (us < 1000000.0) snprintf(buf, size, "%.2f ms", us / 1000.0);
+    else                     snprintf(buf, size, "%.2f s", us / 1000000.0);
+}
+
+static int hud_lines(char lines[HUD_LINES][HUD_LINE_LEN], Uint32 now)
+{
+    int n = 0;
+    double secs = (double)(now - periodStart) / 1000.0;
+    // The loop only presents when something changed, so this is a
+    // presentation rate, not what the game could sustain.
+    if (frames)
+        snprintf(lines[n++], HUD_LINE_LEN, "frame %.2f ms avg, %.2f max, %.1f presented/s",
+                 frameMsSum / frames, frameMsMax, secs > 0 ? frames / secs : 0.0);
+    else
+        snprintf(lines[n++], HUD_LINE_LEN, "frame -, none presented");
+
+    ProcMetrics pm;
+    if (proc_metrics_sample(&pm))
+        snprintf(lines[n++], HUD_LINE_LEN, "RSS %.1f MB", pm.rssKb / 1024.0);
+
+    unsigned long long hits, misses;
+    textcache_stats(&hits, &misses);
+    unsigned long long h = hits - prevHits, m = misses - prevMisses;
+    if (h + m)
+        snprintf(lines[n++], HUD_LINE_LEN, "text cache %.1f%% hits (%llu lookups)",
+                 100.0 * (double)h / (double)(h + m), h + m);
+    else
+        snprintf(lines[n++], HUD_LINE_LEN, "text cache idle");
+    prevHits = hits;
+    prevMisses = misses;
+
+    if (lastBot[0]) {
+        char t[32];
+        hud_time(t, sizeof t, lastMicros);
+        if (lastNodes >= 0)
+            snprintf(lines[n++], HUD_LINE_LEN, "last move %s: %s, %lld nodes", lastBot, t, lastNodes);
+        else
+            snprintf(lines[n++], HUD_LINE_LEN, "last move %s: %s", lastBot, t);
+    }
+    const char *bot;
+    long long moves, lastUs, p99Us;
+    for (int i = 0; n < HUD_LINES && latency_bot_stats(i, &bot, &moves, &lastUs, &p99Us); ++i) {
+        char last[32], p99[32];
+        hud_time(last, sizeof last, (double)lastUs);
+        hud_time(p99, sizeof p99, (double)p99Us);
+        snprintf(lines[n++], HUD_LINE_LEN, "%s: last %s, p99 %s (%lld moves)", bot, last, p99, moves);
+    }
+    return n;
+}
+
+// Re-renders the panel if it is due (or has no texture for this
+// renderer). Returns 1 if it changed.
+int hud_update(SDL_Renderer *r, TTF_Font *font, Uint32 now)
+{
+    if (!font) return 0;
+    if (tex && texOwner == r && (Sint32)(now - nextRefresh) < 0) return 0;
+
+    char lines[HUD_LINES][HUD_LINE_LEN];
+    SDL_Surface *text[HUD_LINES];
+    SDL_Color white = { 235, 235, 235, 255 };
+    int n = hud_lines(lines, now);
+    int w = 0, h = 0;
+    for (int i = 0; i < n; ++i) {
+        text[i] = TTF_RenderUTF8_Blended(font, lines[i], white);
+        if (!text[i]) continue;
+        if (text[i]->w > w) w = text[i]->w;
+        h += text[i]->h;
+    }
+
+    SDL_Surface *panel = SDL_CreateRGBSurfaceWithFormat(0, w + 2*HUD_PAD, h + 2*HUD_PAD, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (panel) {
+        SDL_FillRect(panel, NULL, SDL_MapRGBA(panel->format, 0, 0, 0, 190));
+        int y = HUD_PAD;
+        for (int i = 0; i < n; ++i) {
+            if (!text[i]) continue;
+            SDL_Rect at = { HUD_PAD, y, text[i]->w, text[i]->h };
+            SDL_BlitSurface(text[i], NULL, panel, &at);
+            y += text[i]->h;
+        }
+        if (tex) SDL_DestroyTexture(tex);
+        tex = SDL_CreateTextureFromSurface(r, panel);
+        if (tex) SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        texOwner = r;
+        texW = panel->w;
+        texH = panel->h;
+        SDL_FreeSurface(panel);
+    }
+    for (int i = 0; i < n; ++i)
+        if (text[i]) SDL_FreeSurface(text[i]);
+
+    frames = 0;
+    frameMsSum = frameMsMax = 0.0;
+    periodStart = now;
+    nextRefresh = now + HUD_REFRESH_MS;
+    return 1;
+}
+
+// ms until the panel wants refreshing.
+int hud_next_due(Uint32 now)
+{
+    Sint32 left = (Sint32)(nextRefresh - now);
+    return left > 0 ? (int)left : 0;
+}
+
+// Where the panel is (or would be) drawn with its top-left at x, y.
+SDL_Rect hud_rect(int x, int y)
+{
+    SDL_Rect r = { x, y, tex ? texW : 0, tex ? texH : 0 };
+    return r;
+}
+
+void hud_draw(SDL_Renderer *r, int x, int y)
+{
+    if (!tex || texOwner != r) return;
+    SDL_Rect dst = { x, y, texW, texH };
+    SDL_RenderCopy(r, tex, NULL, &dst);
+}
+
+// Drops the texture (renderer going away or reset).
+void hud_clear(void)
+{
+    if (tex) SDL_DestroyTexture(tex);
+    tex = NULL;
+    texOwner = NULL;
+}
@@ -0,0 +1,119 @@
+// inputlat.c — click-to-photon latency of board moves
+// A human move is followed from the SDL event to the return of the
+// SDL_RenderPresent of the first frame that shows the piece whole, in
+// stages that add up to the total:
+//   queue    event timestamp -> the game scene handles it (ms resolution)
+//   handle   placing the piece
+//   update   the rest of the frame's update, including the bot's reply
+//            (its own time is also given as ai)
+//   render   drawing the first frame after the click, up to SDL_RenderPresent
+//   present  SDL_RenderPresent itself (vsync / swap wait)
+//   anim     from there until a frame with the piece fully grown in is
+//            presented (0 if the first frame already had it)
+// Each stage goes into the latency histograms (latency.c) as "click_*",
+// next to the bots, so it shows up in bot_latency.* and on the overlay;
+// every move is also a row of input_latency.csv, queued to the metrics
+// writer thread (metrics_log.c) like the bot moves.
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+void latency_record(const char *bot, double micros);
+void metrics_log_click(int game, int ply, const char *bot, const double stageUs[]);
+
+typedef struct {
+    int game, ply, cell;
+    char bot[24];               // who replied in the same frame, "none" if nobody did
+    double queue, handle, update, ai, render, present, anim, total;   // us
+} InputRecord;
+
+enum { IL_IDLE, IL_FIRST_FRAME, IL_GROWING };
+
+static int pending = IL_IDLE;
+static int shown = 0;           // the frame being drawn has the piece whole
+static InputRecord cur;
+static Uint64 tHandle, tHandled, tRender, tPresent, tFirst;
+
+static double il_us(Uint64 from, Uint64 to)
+{
+    return (double)(to - from) * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+// A board click on 'cell' (0..8) is being handled; 'timestamp' is the
+// event's (SDL ticks). A previous move whose piece hasn't finished
+// growing in yet is dropped.
+void inputlat_begin(Uint32 timestamp, int game, int ply, int cell)
+{
+    tHandle = SDL_GetPerformanceCounter();
+    memset(&cur, 0, sizeof cur);
+    cur.game = game;
+    cur.ply = ply;
+    cur.cell = cell;
+    snprintf(cur.bot, sizeof cur.bot, "none");
+    Uint32 now = SDL_GetTicks();
+    cur.queue = (Sint32)(now - timestamp) > 0 ? (double)(now - timestamp) * 1000.0 : 0.0;
+    pending = IL_FIRST_FRAME;
+}
+
+// The piece is on the board.
+void inputlat_handled(void)
+{
+    if (pending) tHandled = SDL_GetPerformanceCounter();
+}
+
+// A bot moved before the frame went out.
+void inputlat_bot_move(const char *bot, double micros)
+{
+    if (pending != IL_FIRST_FRAME) return;
+    snprintf(cur.bot, sizeof cur.bot, "%s", bot);
+    cur.ai += micros;
+}
+
+// The frame being drawn shows the piece on 'cell' at full size.
+void inputlat_piece_shown(int cell)
+{
+    if (pending && cell == cur.cell) shown = 1;
+}
+
+// Called around drawing and SDL_RenderPresent of every frame: the first
+// one after a move ends the render/present stages, the first one that
+// shows the piece whole completes it.
+void inputlat_render_start(void)
+{
+    shown = 0;
+    if (pending == IL_FIRST_FRAME) tRender = SDL_GetPerformanceCounter();
+}
+
+void inputlat_present_start(void)
+{
+    if (pending == IL_FIRST_FRAME) tPresent = SDL_GetPerformanceCounter();
+}
+
+void inputlat_presented(void)
+{
+    if (!pending) return;
+    Uint64 tDone = SDL_GetPerformanceCounter();
+    if (pending == IL_FIRST_FRAME) {
+        tFirst = tDone;
+        cur.handle  = il_us(tHandle, tHandled);
+        cur.update  = il_us(tHandled, tRender);
+        cur.render  = il_us(tRender, tPresent);
+        cur.present = il_us(tPresent, tDone);
+        pending = IL_GROWING;
+    }
+    if (!shown) return;
+    pending = IL_IDLE;
+    cur.anim  = il_us(tFirst, tDone);
+    cur.total = cur.queue + il_us(tHandle, tDone);
+
+    latency_record("click_total", cur.total);
+    latency_record("click_queue", cur.queue);
+    latency_record("click_handle", cur.handle);
+    if (strcmp(cur.bot, "none") != 0) latency_record("click_ai", cur.ai);
+    latency_record("click_render", cur.render);
+    latency_record("click_present", cur.present);
+    latency_record("click_anim", cur.anim);
+
+    double stages[8] = { cur.queue, cur.handle, cur.update, cur.ai, cur.render, cur.present, cur.anim, cur.total };
+    metrics_log_click(cur.game, cur.ply, cur.bot, stages);
+}
@@ -0,0 +1,301 @@
+// latency.c — per-bot move latency histograms
+// Each engine ("NaiveBayes", "MinimaxDepth3", ... or any new name) gets
+// an HDR-style histogram: 64 linear sub-buckets per power of two, so any
+// recorded value is reported to within ~1.6%, from 1 us up to 2^41 us,
+// in a fixed 9 KB per bot. Recording is a couple of shifts and an
+// increment. Percentiles (p50/p90/p99/p99.9/max) are read on demand,
+// written at exit, and the same histograms are built from existing
+// bot_metrics.csv files by --latency-report.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define LAT_SUB_BITS   7                  // 128 sub-buckets, the upper 64 used per octave
+#define LAT_HALF       (1 << (LAT_SUB_BITS - 1))
+#define LAT_MAX_SHIFT  34                 // top octave: values below 2^41 us
+#define LAT_BUCKETS    ((LAT_MAX_SHIFT + 2) * LAT_HALF)
+#define LAT_MAX_VALUE  ((1LL << (LAT_MAX_SHIFT + LAT_SUB_BITS)) - 1)
+#define LAT_MAX_BOTS   16                 // bots plus the click_* stages (inputlat.c)
+#define LAT_LINE       512
+
+typedef struct {
+    char name[24];
+    long long count;
+    long long min, max;      // exact, in us
+    long long last;          // most recent move
+    double sum;
+    unsigned counts[LAT_BUCKETS];
+} LatHist;
+
+static LatHist hists[LAT_MAX_BOTS];
+static int nHists = 0;
+static char exitPrefix[256];
+
+static int lat_index(long long v)
+{
+    if (v < 0) v = 0;
+    if (v > LAT_MAX_VALUE) v = LAT_MAX_VALUE;
+    int msb = 0;
+    for (long long t = v | (2 * LAT_HALF - 1); t > 1; t >>= 1) msb++;
+    int shift = msb - (LAT_SUB_BITS - 1);
+    return shift * LAT_HALF + (int)(v >> shift);
+}
+
+// Largest value that lands in bucket i
+static long long lat_bucket_high(int i)
+{
+    int shift = (i < 2 * LAT_HALF) ? 0 : i / LAT_HALF - 1;
+    long long sub = i - shift * LAT_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+static LatHist *lat_find(const char *bot, int create)
+{
+    for (int i = 0; i < nHists; ++i)
+        if (strncmp(hists[i].name, bot, sizeof hists[i].name - 1) == 0)   // names are stored truncated
+            return &hists[i];
+    if (!create) return NULL;
+    if (nHists == LAT_MAX_BOTS) {
+        static int warned = 0;
+        if (!warned) fprintf(stderr, "[latency] more than %d bots, '%s' not recorded\n", LAT_MAX_BOTS, bot);
+        warned = 1;
+        return NULL;
+    }
+    LatHist *h = &hists[nHists++];
+    memset(h, 0, sizeof *h);
+    snprintf(h->name, sizeof h->name, "%s", bot);
+    return h;
+}
+
+// Records one move of 'bot' that took 'micros' microseconds.
+void latency_record(const char *bot, double micros)
+{
+    LatHist *h = lat_find(bot, 1);
+    if (!h) return;
+    long long v = (micros > 0) ? (long long)(micros + 0.5) : 0;
+    if (v > LAT_MAX_VALUE) v = LAT_MAX_VALUE;
+    h->counts[lat_index(v)]++;
+    if (h->count == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->last = v;
+    h->count++;
+    h->sum += (double)v;
+}
+
+// Value (us) at or below which 'pct' percent of the moves fall.
+static long long lat_percentile(const LatHist *h, double pct)
+{
+    if (h->count == 0) return 0;
+    long long want = (long long)(pct / 100.0 * (double)h->count + 0.5);
+    if (want < 1) want = 1;
+    long long seen = 0;
+    for (int i = 0; i < LAT_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= want) {
+            long long v = lat_bucket_high(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+// This session's numbers for the i-th bot seen (the in-game HUD).
+// Returns 0 once i is past the last bot.
+int latency_bot_stats(int i, const char **bot, long long *moves, long long *lastUs, long long *p99Us)
+{
+    if (i < 0 || i >= nHists) return 0;
+    const LatHist *h = &hists[i];
+    *bot = h->name;
+    *moves = h->count;
+    *lastUs = h->last;
+    *p99Us = lat_percentile(h, 99);
+    return 1;
+}
+
+// Prints a percentile table for every bot seen so far.
+void latency_report(FILE *f)
+{
+    fprintf(f, "%-16s %10s %10s %10s %10s %10s %10s %10s\n",
+            "bot", "moves", "mean_us", "p50_us", "p90_us", "p99_us", "p999_us", "max_us");
+    for (int i = 0; i < nHists; ++i) {
+        const LatHist *h = &hists[i];
+        fprintf(f, "%-16s %10lld %10.0f %10lld %10lld %10lld %10lld %10lld\n",
+                h->name, h->count, h->count ? h->sum / (double)h->count : 0.0,
+                lat_percentile(h, 50), lat_percentile(h, 90), lat_percentile(h, 99),
+                lat_percentile(h, 99.9), h->max);
+    }
+}
+
+static void lat_dat_path(char *out, size_t size, const char *prefix, const char *bot)
+{
+    char safe[24];
+    size_t n = 0;
+    for (; bot[n] && n < sizeof safe - 1; ++n) {
+        char c = bot[n];
+        int ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+        safe[n] = ok ? c : '_';
+    }
+    safe[n] = '\0';
+    snprintf(out, size, "%s_%s.dat", prefix, safe);
+}
+
+// Writes <prefix>.txt (the table), one <prefix>_<bot>.dat percentile
+// distribution per bot and <prefix>.gnu to plot them. Returns 0 on failure.
+int latency_export(const char *prefix)
+{
+    char path[300];
+    FILE *f;
+    int ok = 1;
+
+    snprintf(path, sizeof path, "%s.txt", prefix);
+    if (!(f = fopen(path, "w"))) return 0;
+    latency_report(f);
+    fclose(f);
+
+    for (int b = 0; b < nHists; ++b) {
+        const LatHist *h = &hists[b];
+        lat_dat_path(path, sizeof path, prefix, h->name);
+        if (!(f = fopen(path, "w"))) { ok = 0; continue; }
+        // one row per non-empty bucket; 1/(1-p) spreads the tail out on a log axis
+        fprintf(f, "# %s: %lld moves\n# value_us   percentile   count   1/(1-percentile)\n", h->name, h->count);
+        long long seen = 0;
+        for (int i = 0; i < LAT_BUCKETS; ++i) {
+            if (!h->counts[i]) continue;
+            seen += h->counts[i];
+            double p = (double)seen / (double)h->count;
+            long long v = lat_bucket_high(i);
+            fprintf(f, "%lld   %.6f   %lld   %.2f\n", v < h->max ? v : h->max, p, seen,
+                    seen < h->count ? 1.0 / (1.0 - p) : (double)h->count);
+        }
+        fclose(f);
+    }
+
+    snprintf(path, sizeof path, "%s.gnu", prefix);
+    if (!(f = fopen(path, "w"))) return 0;
+    fprintf(f, "set terminal pngcairo size 800,500 enhanced font \"Arial,12\"\n"
+               "set output \"%s.png\"\n\n"
+               "set title \"Bot move and click-to-photon latency by percentile\"\n"
+               "set logscale xy\n"
+               "set xlabel \"Percentile\"\n"
+               "set ylabel \"Time (us)\"\n"
+               "set xtics (\"0%%\" 1, \"90%%\" 10, \"99%%\" 100, \"99.9%%\" 1000, \"99.99%%\" 10000)\n"
+               "set key top left\n\n", prefix);
+    for (int b = 0; b < nHists; ++b) {
+        lat_dat_path(path, sizeof path, prefix, hists[b].name);
+        fprintf(f, "%s \"%s\" using 4:1 with steps lw 2 title \"%s\"%s\n",
+                b ? "    " : "plot", path, hists[b].name, b + 1 < nHists ? ", \\" : "");
+    }
+    fclose(f);
+    return ok;
+}
+
+static void latency_at_exit(void)
+{
+    if (nHists && exitPrefix[0] && !latency_export(exitPrefix))
+        fprintf(stderr, "[latency] couldn't write '%s' files\n", exitPrefix);
+}
+
+// Exports the session's histograms under 'prefix' when the program exits.
+void latency_export_at_exit(const char *prefix)
+{
+    static int registered = 0;
+    snprintf(exitPrefix, sizeof exitPrefix, "%s", prefix);
+    if (!registered) atexit(latency_at_exit);
+    registered = 1;
+}
+
+// Feeds one metrics CSV into the histograms. The bot and time columns
+// are found from the header, so older files with fewer columns work too.
+static long long lat_load_csv(const char *path, long long *bad)
+{
+    char line[LAT_LINE];
+    FILE *f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "[latency] can't open '%s'\n", path); return -1; }
+    setvbuf(f, NULL, _IOFBF, 1 << 16);
+
+    int botCol = -1, timeCol = -1;
+    if (fgets(line, sizeof line, f)) {
+        int col = 0;
+        for (char *p = line; ; ++col) {
+            size_t len = strcspn(p, ",\r\n");
+            if (len == 3 && strncmp(p, "bot", 3) == 0) botCol = col;
+            if (len == 19 && strncmp(p, "time_taken_per_move", 19) == 0) timeCol = col;
+            if (p[len] != ',') break;
+            p += len + 1;
+        }
+    }
+    if (botCol < 0 || timeCol < 0) {
+        fprintf(stderr, "[latency] '%s' has no bot/time_taken_per_move columns\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    long long rows = 0;
+    while (fgets(line, sizeof line, f)) {
+        char *bot = NULL, *time = NULL;
+        int col = 0;
+        for (char *p = line; ; ++col) {
+            size_t len = strcspn(p, ",\r\n");
+            char end = p[len];
+            p[len] = '\0';
+            if (col == botCol) bot = p;
+            if (col == timeCol) time = p;
+            if (end != ',') break;
+            p += len + 1;
+        }
+        char *stop;
+        double micros = time ? strtod(time, &stop) : 0;
+        if (!bot || !*bot || !time || stop == time) { (*bad)++; continue; }
+        latency_record(bot, micros);
+        rows++;
+    }
+    fclose(f);
+    return rows;
+}
+
+// ttt.exe --latency-report [--out <prefix>] [metrics csv files...]
+// With no files: bot_metrics.csv and its rotated copies.
+int latency_main(int argc, char *argv[])
+{
+    const char *prefix = "bot_latency";
+    const char **files = malloc(sizeof(char *) * (size_t)(argc + 4));
+    char rotated[3][32];
+    int nFiles = 0;
+    if (!files) return 1;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) prefix = argv[++i];
+        else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "usage: %s --latency-report [--out <prefix>] [metrics csv files...]\n", argv[0]);
+            free(files);
+            return 1;
+        }
+        else files[nFiles++] = argv[i];
+    }
+    if (nFiles == 0) {
+        files[nFiles++] = "bot_metrics.csv";
+        for (int i = 0; i < 3; ++i) {
+            snprintf(rotated[i], sizeof rotated[i], "bot_metrics.csv.%d", i + 1);
+            FILE *f = fopen(rotated[i], "r");
+            if (f) { fclose(f); files[nFiles++] = rotated[i]; }
+        }
+    }
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    long long rows = 0, bad = 0;
+    for (int i = 0; i < nFiles; ++i) {
+        long long n = lat_load_csv(files[i], &bad);
+        if (n > 0) rows += n;
+    }
+    free(files);
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+
+    latency_report(stdout);
+    printf("%lld moves (%lld rows skipped) in %.2f s\n", rows, bad, secs);
+    if (!latency_export(prefix)) {
+        fprintf(stderr, "[latency] couldn't write '%s' files\n", prefix);
+        return 1;
+    }
+    printf("Wrote %s.txt, %s_<bot>.dat and %s.gnu (gnuplot %s.gnu)\n", prefix, prefix, prefix, prefix);
+    return 0;
+}
@@ -1,6 +1,6 @@
 // main.c — SDL2 Tic-Tac-Toe
 // Build (UCRT64):
-//   gcc main.c Minimax.c N_bayes.c -o ttt.exe \
+//   gcc main.c Minimax.c N_bayes.c playback.c selfplay.c mapfile.c gamedb.c posindex.c notation.c analysis.c metrics_log.c proc_metrics.c latency.c trace.c textcache.c sprites.c geom.c anim.c hud.c inputlat.c -o ttt.exe \
 //     -IC:/msys64/ucrt64/include/SDL2 -LC:/msys64/ucrt64/lib \
 //     -lmingw32 -lSDL2main -lSDL2 -lSDL2_ttf -lm -mwindows
 
@@ -12,18 +12,17 @@
 #include <time.h>
 #include <math.h>
 
+// Render calls made from this file are counted (for --sprite-bench)
+static unsigned long drawCalls = 0;
+#define SDL_RenderDrawLine(...)  (drawCalls++, SDL_RenderDrawLine(__VA_ARGS__))
+#define SDL_RenderDrawPoint(...) (drawCalls++, SDL_RenderDrawPoint(__VA_ARGS__))
+#define SDL_RenderDrawRect(...)  (drawCalls++, SDL_RenderDrawRect(__VA_ARGS__))
+#define SDL_RenderFillRect(...)  (drawCalls++, SDL_RenderFillRect(__VA_ARGS__))
+#define SDL_RenderCopy(...)      (drawCalls++, SDL_RenderCopy(__VA_ARGS__))
 
 
-//DECLARE LIBRARY TO GET WINDOWS API HEADER
-//TO GET SYSTEM INFO, memory and exec time
-#include <windows.h>
-#include <psapi.h>
-
 
 // ------------ Window / board sizing ------------
-//DECLARE LIBRARY TO GET WINDOWS API HEADER
-//TO GET SYSTEM INFO, memory and exec tim
-// Window / board sizing
 #define WINDOW_WIDTH   600
 #define WINDOW_HEIGHT  840
 
@@ -38,10 +37,18 @@
 #define BOARD_BOTTOM_PAD           36
 #define WINLINE_THICKNESS          8
 
+#define HINT_IDLE_MS               5000   // human idle this long -> show a hint
+#define HINT_BLINK_MS              400    // hint cell on/off period
+
+#define WINLINE_MS                 600    // win line drawing itself
+#define BANNER_MS                  1100   // result banner shown (fades in and out)
+#define BANNER_FADE_MS             200
+#define PLACE_MS                   160    // a placed piece growing into its cell
+
 // Game types
 typedef enum { EMPTY=0, X=1, O=2 } Cell;
 typedef enum { MODE_MP=1, MODE_SP=2 } GameMode;
-typedef enum { DIFF_BACK=-1, DIFF_EASY=0, DIFF_MEDIUM=1, DIFF_HARD=2 } Difficulty;
+typedef enum { DIFF_EASY=0, DIFF_MEDIUM=1, DIFF_HARD=2 } Difficulty;
 typedef enum { SIDE_X=0, SIDE_O=1 } PlayerSide;
 typedef enum { ICON_NONE=0, ICON_SOLO=1, ICON_DUO=2 } ButtonIcon;
 typedef enum { THEME_DARK=0, THEME_FUN=1 } Theme;
@@ -55,14 +62,86 @@ int find_blocking_move_against_ai(Cell b[3][3], Cell aiPiece);
 //depthLimit for how far the AI searches
 //blunderPct for making suboptimal moves to simulate human error
 int bestMove_minimax_for(Cell b[3][3], Cell aiPiece, int depthLimit, int blunderPct); // aiPiece is the AI's chosen piece
+int bestMove_minimax_nodes(Cell b[3][3], Cell aiPiece, int depthLimit, int blunderPct, long long *nodes);
 
 int bestMove_naive_bayes_for(Cell b[3][3], Cell aiPiece); // best move based on trained data, but for AI's piece
 void nb_train_from_file(const char* path);  // references to N_bayes.c for training data
+int  nb_load_snapshot(const char *path);   // model learned from previous sessions
+void nb_flush_snapshot(void);              // save what was learned this session
+void nb_kfold_cross_validate(const char *path, int k, unsigned long long seed, int nThreads); // report only
+long long nb_train_sharded(const char *const *paths, int nPaths, int nThreads); // multi-threaded training
+void nb_train_scaling_report(const char *const *paths, int nPaths, int maxThreads);
+int  nb_save_snapshot(const char *path);
+long long nb_train_dedup(const char *const *paths, int nPaths, int nThreads, int canonical, int augment);
+void nb_dedup_report(const char *const *paths, int nPaths, int nThreads,
+                     int canonical, int augment, int k, unsigned long long seed);
+int  selfplay_main(int argc, char *argv[]);  // headless dataset generator (selfplay.c)
+int  gamedb_main(int argc, char *argv[]);    // game database build / query (gamedb.c)
+int  posindex_main(int argc, char *argv[]);  // position index build / query (posindex.c)
+int  notation_main(int argc, char *argv[]);  // text import / export of games (notation.c)
+int  latency_main(int argc, char *argv[]);   // latency percentiles from metrics CSVs (latency.c)
+int  metrics_log_open(const char *path, const char *header, int *lastGame);  // async bot_metrics.csv writer
+int  metrics_log_open_clicks(const char *path, const char *header);          // ... and input_latency.csv
+// This struct must match the one in proc_metrics.c
+typedef struct {
+    long long rssKb, peakRssKb;            // -1 where the platform can't say
+    long long userCpuUs, sysCpuUs;
+    long long volCtxSwitches, involCtxSwitches;
+} ProcMetrics;
+int  proc_metrics_sample(ProcMetrics *m);  // memory / CPU / context switches (proc_metrics.c)
+void metrics_log_move(int game, int move, const char *bot, double micros, long long nodes,
+                      const ProcMetrics *now, const ProcMetrics *before);
+void metrics_log_close(void);
+void latency_record(const char *bot, double micros);   // per-bot latency histograms (latency.c)
+void latency_report(FILE *f);
+int  latency_export(const char *prefix);
+void latency_export_at_exit(const char *prefix);
+extern SDL_atomic_t traceOn;                  // zone profiler, Chrome trace output (trace.c)
+int  trace_init(const char *path);
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+void trace_shutdown(void);
+SDL_Texture *textcache_get(SDL_Renderer *r, TTF_Font *font, const char *text, SDL_Color color);  // textcache.c
+void textcache_clear(void);
+int  sprite_get(SDL_Renderer *r, const void *key, int keySize, int w, int h,   // shape atlas (sprites.c)
+                void (*paint)(int x, int y, const void *key), SDL_Texture **tex, SDL_Rect *src);
+void sprite_clear(void);
+void geom_line(float x1, float y1, float x2, float y2, float thickness, SDL_Color c);   // geom.c
+void geom_disc(float cx, float cy, float r, SDL_Color c);
+void geom_ring(float cx, float cy, float r, float width, SDL_Color c);
+void geom_rounded_rect(SDL_Rect r, float rad, SDL_Color c);
+void geom_rounded_rect_outline(SDL_Rect r, float rad, float width, SDL_Color c);
+int  geom_flush(SDL_Renderer *r);
+#define geom_flush(r) (drawCalls += (unsigned long)geom_flush(r))   // counted like the SDL_Render* calls
+enum { EASE_LINEAR, EASE_OUT, EASE_IN_OUT };   // must match the one in anim.c
+void  anim_start(int id, Uint32 now, Uint32 delay, Uint32 duration, int ease);   // timeline (anim.c)
+void  anim_stop(int id);
+void  anim_stop_all(void);
+float anim_value(int id, Uint32 now);
+int   anim_done(int id, Uint32 now);
+int   anim_frame(int id, Uint32 now);
+int   anim_next_due(Uint32 now);
+void     hud_frame(double ms);                                   // performance overlay (hud.c)
+void     hud_bot_move(const char *bot, double micros, long long nodes);
+int      hud_update(SDL_Renderer *r, TTF_Font *font, Uint32 now);
+int      hud_next_due(Uint32 now);
+SDL_Rect hud_rect(int x, int y);
+void     hud_draw(SDL_Renderer *r, int x, int y);
+void     hud_clear(void);
+void inputlat_begin(Uint32 timestamp, int game, int ply, int cell);   // click-to-photon latency (inputlat.c)
+void inputlat_handled(void);
+void inputlat_bot_move(const char *bot, double micros);
+void inputlat_piece_shown(int cell);
+void inputlat_render_start(void);
+void inputlat_present_start(void);
+void inputlat_presented(void);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
 
 // UI-related
 static void renderGame(void);   // draws game board
-static Theme themeMenu(void);   // calls function that allows user to choose theme
-static void playbackScreen(void);  // calls function that shows history of most recent game
+static void drawGame(void);
+static void markDirty(SDL_Rect r);   // redraw just this part of the screen
 
 
 // core state of SDL objects
@@ -70,6 +149,10 @@ Cell board[3][3];
 SDL_Window *window = NULL;
 SDL_Renderer *renderer = NULL;
 TTF_Font *font = NULL;
+TTF_Font *hudFont = NULL;       // small font for the performance overlay
+static int hudVisible = 0;      // F3
+#define HUD_X 8
+#define HUD_Y 8
 
 Theme currentTheme = THEME_DARK;    // sets current theme to Dark
 
@@ -79,19 +162,31 @@ Uint32 lastHumanActivityTicks = 0;
 static const SDL_Color hintFill = { 70, 96, 140, 255 };
 
 // ------ CALCULATE GAME METRICS ------
-static FILE *metricsLog = NULL;
 static int gameIndex = 0;   // current game number
 static int moveIndex = 0;   // move number
-static size_t last_process_memory_kb = 0;
+static long long last_process_memory_kb = 0;
 
 
 // PLAYBACK FUNCTION
 void playback_begin_new_game(void);
 void playback_record_move(int row, int col, Cell piece);
-void playback_finalize_game(void);
+void playback_init(void);
+void playback_shutdown(void);
+void playback_finalize_game(int mode, int difficulty);
+void playback_set_bulk(int on, int learn);
 int  playback_has_last_game(void);
+int  playback_game_count(void);
+int  playback_select_game(int back);
+int  playback_selected_game_id(void);
 int  playback_get_move_count(void);
 void playback_build_board_at_step(int step, Cell outBoard[3][3]);
+int  playback_cursor_step(void);
+void playback_cursor_board(Cell outBoard[3][3]);
+int  playback_step_forward(void);
+int  playback_step_back(void);
+void playback_seek(int step);
+long long posindex_lookup(const Cell board[3][3], long long results[3]);  // posindex.c
+int  analysis_annotation(unsigned gameId, int step, char *buf, int size);  // analysis.c
 
 
 // PLAYBACK FUNCTION
@@ -104,11 +199,18 @@ int scoreX = 0, scoreO = 0;
 int firstPlayer = 1;            // 1 -> X starts, 2 -> O starts
 
 // UI state
-int needsRedraw = 1;
+int needsRedraw = 1;            // whole game screen
+SDL_Rect dirtyRect = {0};       // or just this part of it (w == 0: nothing)
 SDL_Rect backButton = {0};
 SDL_Rect resetButton = {0};
 SDL_Rect boardRect  = {0};
 
+// End of a game: the win line and result banner play while the finished
+// board stays up; a click or the end of the banner starts the next game
+int roundOver = 0;
+static char resultText[32] = "";
+enum { ANIM_WIN_LINE, ANIM_BANNER_IN, ANIM_BANNER_OUT, ANIM_PLACE };   // anim.c tracks; ANIM_PLACE + cell
+
 // Colors
 static const SDL_Color xColor     = { 60, 230,  90, 255}; // default X
 static const SDL_Color oColor     = {250, 160, 170, 255}; // default O
@@ -154,12 +256,9 @@ static void initBoard(void) {
 }
 
 // text rendering utility in SDL2 with SDL2_ttf
-static SDL_Texture* createTextTexture(const char* text, TTF_Font* fnt, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(fnt, text, color);
-    if (!surface) return NULL;
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
-    return texture;
+// (cached in textcache.c: don't destroy the texture)
+static SDL_Texture* getTextTexture(const char* text, TTF_Font* fnt, SDL_Color color) {
+    return textcache_get(renderer, fnt, text, color);
 }
 
 // win-detection logic (checks rows, columns, diagonals)
@@ -195,31 +294,20 @@ static int getWinLine(int *r1, int *c1, int *r2, int *c2)
 }
 
 // SDL renderer for GUI
+// Shapes are drawn opaque, as they were when the draw blend mode (NONE)
+// wrote colours straight through; only antialiased edges blend.
+// The shape helpers only add to the geom batch: whoever paints a sprite
+// or a pass calls geom_flush() once, before drawing anything else.
+static SDL_Color opaque(SDL_Color c) { c.a = 255; return c; }
+
+// thickness/2 pixels either side of the centre line, as one antialiased quad
 static void drawThickLine(float x1, float y1, float x2, float y2, int thickness, SDL_Color color)
 {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-
-    float dx = x2 - x1, dy = y2 - y1;
-    float len = sqrtf(dx*dx + dy*dy);
-    if (len == 0) return;
-    dx /= len; dy /= len;
-
-    float nx = -dy, ny = dx;
-    int half = thickness / 2;
-
-    for (int i = -half; i <= half; i++) {
-        float ox = nx * i;
-        float oy = ny * i;
-        SDL_RenderDrawLine(renderer,
-                           (int)(x1 + ox),
-                           (int)(y1 + oy),
-                           (int)(x2 + ox),
-                           (int)(y2 + oy));
-    }
+    geom_line(x1, y1, x2, y2, (float)(2*(thickness/2) + 1), opaque(color));
 }
 
-// Animation of Win Line
-static void animateWinLine(SDL_Rect boardRect, SDL_Color lineColor)
+// Winning line, drawn from its start to fraction t (0..1) of its length
+static void drawWinLine(float t, SDL_Color lineColor)
 {
     int r1, c1, r2, c2;
     int winner = getWinLine(&r1, &c1, &r2, &c2);
@@ -245,51 +333,9 @@ static void animateWinLine(SDL_Rect boardRect, SDL_Color lineColor)
         y2 += dy * extend;
     }
 
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-
-    const float duration_ms = 600.0f;
-    Uint32 start = SDL_GetTicks();
-
-    // animation loop
-    for (;;) {
-        float t = (SDL_GetTicks() - start) / duration_ms;
-        if (t > 1.0f) t = 1.0f;
-
-        renderGame();
-
-        float cx = x1 + (x2 - x1) * t;
-        float cy = y1 + (y2 - y1) * t;
-
-        SDL_Color c = lineColor;
-        SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
-        float ldx = x2 - x1, ldy = y2 - y1;
-        float llen = sqrtf(ldx*ldx + ldy*ldy);
-        float nx = 0.0f, ny = 0.0f;
-        if (llen > 0.0f) {
-            nx = -ldy / llen;
-            ny =  ldx / llen;
-        }
-
-        int half = WINLINE_THICKNESS / 2;
-        for (int i = -half; i <= half; ++i) {
-            int ox = (int)roundf(nx * i);
-            int oy = (int)roundf(ny * i);
-            SDL_RenderDrawLine(renderer,
-                               (int)(x1 + ox), (int)(y1 + oy),
-                               (int)(cx + ox), (int)(cy + oy));
-        }
-
-        SDL_RenderPresent(renderer);
-        if (t >= 1.0f) break;
-        SDL_Delay(16);
-    }
-
-    // draw winning line that stays on page
-    renderGame();
-    SDL_Color c = lineColor;
-    SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
-    drawThickLine(x1, y1, x2, y2, WINLINE_THICKNESS, c);
-    SDL_RenderPresent(renderer);
+    float cx = x1 + (x2 - x1) * t;
+    float cy = y1 + (y2 - y1) * t;
+    drawThickLine(x1, y1, cx, cy, WINLINE_THICKNESS, lineColor);
 }
 
 // SDL renderer for GUI
@@ -298,143 +344,70 @@ static void setColor(SDL_Color c){
 }
 
 //  Render player icon
-static void hline(int x1, int x2, int y)
+// Ring with a transparent middle; pixel (cx, cy) is the centre, as it
+// was for the old scanline fill.
+static void fillRing(int cx, int cy, int outerR, int thickness, SDL_Color ringColor)
 {
-    if (x2 < x1) { int t = x1; x1 = x2; x2 = t; }
-    SDL_RenderDrawLine(renderer, x1, y, x2, y);
-}
-
-static void fillCircle(int cx, int cy, int r)
-{
-    for (int dy = -r; dy <= r; ++dy) {
-        int dx = (int)(sqrt((double)r*r - (double)dy*dy) + 0.5);
-        hline(cx - dx, cx + dx, cy + dy);
-    }
-}
-
-static void fillRing(int cx, int cy, int outerR, int thickness,
-                     SDL_Color ringColor, SDL_Color bgColorLocal)
-{
-    setColor(ringColor);
-    fillCircle(cx, cy, outerR);
-
-    int innerR = outerR - thickness;
-    if (innerR > 0) {
-        setColor(bgColorLocal);
-        fillCircle(cx, cy, innerR);
-    }
+    TRACE_BEGIN("fillRing", "shape");
+    geom_ring(cx + 0.5f, cy + 0.5f, outerR + 0.5f, (float)thickness, opaque(ringColor));
+    TRACE_END();
 }
 
 // Render button shapes
 static void drawRoundedRectFilled(SDL_Rect r, int rad, SDL_Color fill)
 {
-    if (rad < 1) {
-        setColor(fill);
-        SDL_RenderFillRect(renderer, &r);
-        return;
-    }
-    if (rad*2 > r.w) rad = r.w/2;
-    if (rad*2 > r.h) rad = r.h/2;
-
-    setColor(fill);
-
-    SDL_Rect mid = { r.x + rad, r.y, r.w - 2*rad, r.h };
-    SDL_RenderFillRect(renderer, &mid);
-
-    SDL_Rect left = { r.x, r.y + rad, rad, r.h - 2*rad };
-    SDL_Rect right= { r.x + r.w - rad, r.y + rad, rad, r.h - 2*rad };
-    SDL_RenderFillRect(renderer, &left);
-    SDL_RenderFillRect(renderer, &right);
-
-    for (int dy = -rad; dy <= rad; ++dy) {
-        int dx = (int)(sqrt((double)rad*rad - (double)dy*dy) + 0.5);
-        hline(r.x + rad - dx,           r.x + rad,           r.y + rad - dy);
-        hline(r.x + r.w - rad,          r.x + r.w - rad + dx,r.y + rad - dy);
-        hline(r.x + rad - dx,           r.x + rad,           r.y + r.h - rad + dy);
-        hline(r.x + r.w - rad,          r.x + r.w - rad + dx,r.y + r.h - rad + dy);
-    }
+    TRACE_BEGIN("drawRoundedRectFilled", "shape");
+    geom_rounded_rect(r, (float)(rad > 0 ? rad : 0), opaque(fill));
+    TRACE_END();
 }
 
+// 1-pixel border along the inside of r
 static void drawRoundedRectOutline(SDL_Rect r, int rad, SDL_Color border)
 {
-    if (rad < 1) {
-        setColor(border);
-        SDL_RenderDrawRect(renderer, &r);
-        return;
-    }
-    if (rad*2 > r.w) rad = r.w/2;
-    if (rad*2 > r.h) rad = r.h/2;
-
-    setColor(border);
-
-    SDL_RenderDrawLine(renderer, r.x + rad, r.y, r.x + r.w - rad - 1, r.y);
-    SDL_RenderDrawLine(renderer, r.x + rad, r.y + r.h - 1, r.x + r.w - rad - 1, r.y + r.h - 1);
-    SDL_RenderDrawLine(renderer, r.x, r.y + rad, r.x, r.y + r.h - rad - 1);
-    SDL_RenderDrawLine(renderer, r.x + r.w - 1, r.y + rad, r.x + r.w - 1, r.y + r.h - rad - 1);
-
-    for (int a = 0; a <= rad; ++a) {
-        int b = (int)(sqrt((double)rad*rad - (double)a*a) + 0.5);
-        SDL_RenderDrawPoint(renderer, r.x + rad - a,           r.y + rad - b);
-        SDL_RenderDrawPoint(renderer, r.x + rad - b,           r.y + rad - a);
-        SDL_RenderDrawPoint(renderer, r.x + r.w - rad - 1 + a, r.y + rad - b);
-        SDL_RenderDrawPoint(renderer, r.x + r.w - rad - 1 + b, r.y + rad - a);
-        SDL_RenderDrawPoint(renderer, r.x + rad - a,           r.y + r.h - rad - 1 + b);
-        SDL_RenderDrawPoint(renderer, r.x + rad - b,           r.y + r.h - rad - 1 + a);
-        SDL_RenderDrawPoint(renderer, r.x + r.w - rad - 1 + a, r.y + r.h - rad - 1 + b);
-        SDL_RenderDrawPoint(renderer, r.x + r.w - rad - 1 + b, r.y + r.h - rad - 1 + a);
-    }
+    TRACE_BEGIN("drawRoundedRectOutline", "shape");
+    geom_rounded_rect_outline(r, (float)(rad > 0 ? rad : 0), 1.0f, opaque(border));
+    TRACE_END();
 }
 
 // render pieces (X, O)
 static void drawThickDiag(int x1, int y1, int x2, int y2, int thickness, SDL_Color color)
 {
-    setColor(color);
-    double dx = (double)(x2 - x1);
-    double dy = (double)(y2 - y1);
-    double len = sqrt(dx*dx + dy*dy);
-    if (len == 0) return;
-    double nx = -dy / len;
-    double ny =  dx / len;
-
-    int half = thickness / 2;
-    for (int t = -half; t <= half; ++t) {
-        int ox = (int)round(nx * t);
-        int oy = (int)round(ny * t);
-        SDL_RenderDrawLine(renderer, x1+ox, y1+oy, x2+ox, y2+oy);
-    }
+    geom_line(x1 + 0.5f, y1 + 0.5f, x2 + 0.5f, y2 + 0.5f, (float)(2*(thickness/2) + 1), opaque(color));
 }
 
-static void drawXIcon(SDL_Rect cell, int inset, int thickness, SDL_Color color)
+static void paintXIcon(SDL_Rect cell, int inset, int thickness, SDL_Color color)
 {
     int x0 = cell.x + inset;
     int y0 = cell.y + inset;
     int x1 = cell.x + cell.w - inset;
     int y1 = cell.y + cell.h - inset;
 
+    TRACE_BEGIN("drawXIcon", "shape");
     drawThickDiag(x0, y0, x1, y1, thickness, color);
     drawThickDiag(x0, y1, x1, y0, thickness, color);
+    TRACE_END();
 }
 
-static void drawOIcon(SDL_Rect cell, int inset, int thickness,
-                      SDL_Color color, SDL_Color bgColorLocal)
+static void paintOIcon(SDL_Rect cell, int inset, int thickness, SDL_Color color)
 {
     int cx = cell.x + cell.w/2;
     int cy = cell.y + cell.h/2;
     int outerR = (cell.w < cell.h ? cell.w : cell.h)/2 - inset;
     if (outerR < thickness) outerR = thickness;
-    fillRing(cx, cy, outerR, thickness, color, bgColorLocal);
+    fillRing(cx, cy, outerR, thickness, color);
 }
 
-// Person icons for buttons
-static void drawPersonOutline(int x, int y, int size, int stroke,
-                              SDL_Color col, SDL_Color bg)
+static void paintPersonOutline(int x, int y, int size, int stroke,
+                               SDL_Color col, SDL_Color bg)
 {
     if (stroke < 1) stroke = 1;
 
     int headR   = (int)round(size * 0.28);
     int cx      = x + size/2;
     int cy      = y + (int)round(size * 0.28);
-    fillRing(cx, cy, headR, stroke, col, bg);
+    // the head is filled with bg so the front figure of a pair hides the back one
+    geom_disc(cx + 0.5f, cy + 0.5f, headR + 0.5f, opaque(bg));
+    fillRing(cx, cy, headR, stroke, col);
 
     int barW = (int)round(size * 0.88);
     int barH = (int)round(size * 0.40);
@@ -452,14 +425,172 @@ static void drawPersonOutline(int x, int y, int size, int stroke,
     drawRoundedRectFilled(neck, neckH/2, bg);
 }
 
-static void drawTwoPeopleOutline(int x, int y, int size, int stroke,
-                                 SDL_Color col, SDL_Color bg)
+static void paintTwoPeopleOutline(int x, int y, int size, int stroke,
+                                  SDL_Color col, SDL_Color bg)
 {
     int bSize = (int)round(size * 0.86);
     int bx    = x + (int)round(size * 0.24);
     int by    = y - (int)round(size * 0.08);
-    drawPersonOutline(bx, by, bSize, stroke, col, bg);
-    drawPersonOutline(x,  y,  size,  stroke, col, bg);
+    paintPersonOutline(bx, by, bSize, stroke, col, bg);
+    paintPersonOutline(x,  y,  size,  stroke, col, bg);
+}
+
+// ------------ Sprite atlas ------------
+// Cards, X/O and person icons are painted once per look (size, colours)
+// into the atlas in sprites.c and copied from there; a theme change
+// clears it. Colours are baked opaque, as they are when drawn directly;
+// only the antialiased edges are translucent.
+enum { SPR_CARD = 1, SPR_XICON, SPR_OICON, SPR_PERSON, SPR_TWO_PEOPLE };
+typedef struct {
+    int kind;
+    int w, h;           // sprite size
+    int a, b;           // card: radius; icons: inset / size, stroke
+    int hasBorder;
+    SDL_Color c1, c2;   // fill or icon colour; border or background
+} SpriteKey;
+
+static int useSprites = 1;   // 0 = draw every shape directly (benchmarks)
+
+static void paintSprite(int x, int y, const void *key)
+{
+    const SpriteKey *k = (const SpriteKey *)key;
+    SDL_Rect r = { x, y, k->w, k->h };
+    switch (k->kind) {
+    case SPR_CARD:
+        drawRoundedRectFilled(r, k->a, k->c1);
+        if (k->hasBorder) drawRoundedRectOutline(r, k->a, k->c2);
+        break;
+    case SPR_XICON:      paintXIcon(r, k->a, k->b, k->c1); break;
+    case SPR_OICON:      paintOIcon(r, k->a, k->b, k->c1); break;
+    case SPR_PERSON:     paintPersonOutline(x, y, k->a, k->b, k->c1, k->c2); break;
+    case SPR_TWO_PEOPLE: paintTwoPeopleOutline(x, y + (int)round(k->a * 0.08), k->a, k->b, k->c1, k->c2); break;
+    }
+    geom_flush(renderer);       // the whole sprite in one call
+}
+
+// Atlas paint callback: the slot starts as the outermost colour at alpha
+// 0, so antialiased edges keep their colour and only fade out.
+static void paintSpriteSlot(int x, int y, const void *key)
+{
+    const SpriteKey *k = (const SpriteKey *)key;
+    SDL_Rect r = { x, y, k->w, k->h };
+    SDL_Color edge = (k->kind == SPR_CARD) ? k->c2 : k->c1;
+    SDL_SetRenderDrawColor(renderer, edge.r, edge.g, edge.b, 0);
+    SDL_RenderFillRect(renderer, &r);
+    paintSprite(x, y, key);
+}
+
+// Draws k with its top-left at x,y, from the atlas when possible.
+static void drawSprite(const SpriteKey *k, int x, int y)
+{
+    SDL_Texture *tex;
+    SDL_Rect src;
+    if (useSprites && sprite_get(renderer, k, (int)sizeof *k, k->w, k->h, paintSpriteSlot, &tex, &src)) {
+        SDL_Rect dst = { x, y, k->w, k->h };
+        SDL_RenderCopy(renderer, tex, &src, &dst);
+    } else {
+        paintSprite(x, y, k);
+    }
+}
+
+// A piece appearing: k at fraction 'grow' (0..1) of its size about its
+// centre, faded in as it grows. Needs the atlas; drawn directly it just
+// appears whole.
+static void drawSpriteGrowing(const SpriteKey *k, int x, int y, float grow)
+{
+    SDL_Texture *tex;
+    SDL_Rect src;
+    if (grow >= 1.0f || !useSprites ||
+        !sprite_get(renderer, k, (int)sizeof *k, k->w, k->h, paintSpriteSlot, &tex, &src)) {
+        drawSprite(k, x, y);
+        return;
+    }
+    if (grow <= 0.0f) return;
+    float scale = 0.5f + 0.5f * grow;
+    int w = (int)(k->w * scale + 0.5f), h = (int)(k->h * scale + 0.5f);
+    SDL_Rect dst = { x + (k->w - w) / 2, y + (k->h - h) / 2, w, h };
+    SDL_SetTextureAlphaMod(tex, (Uint8)(255.0f * grow));
+    SDL_RenderCopy(renderer, tex, &src, &dst);
+    SDL_SetTextureAlphaMod(tex, 255);
+}
+
+static SpriteKey spriteKey(int kind, int w, int h, int a, int b, SDL_Color c1, SDL_Color c2)
+{
+    SpriteKey k;
+    memset(&k, 0, sizeof k);    // padding is part of the key
+    k.kind = kind;
+    k.w = w;
+    k.h = h;
+    k.a = a;
+    k.b = b;
+    k.c1 = opaque(c1);
+    k.c2 = opaque(c2);
+    return k;
+}
+
+// Filled rounded rectangle with an optional border, as a nine-slice:
+// the sprite is only 2*rad+3 pixels square; corners are copied 1:1 and
+// the edges are stretched from its centre row/column.
+static void drawRoundedCard(SDL_Rect r, int rad, SDL_Color fill, const SDL_Color *border)
+{
+    int c = rad + 1, size = 2*c + 1;
+    SpriteKey k = spriteKey(SPR_CARD, size, size, rad, 0, fill, border ? *border : fill);
+    k.hasBorder = (border != NULL);
+    SDL_Texture *tex;
+    SDL_Rect src;
+    if (!useSprites || rad < 1 || r.w < size || r.h < size ||
+        !sprite_get(renderer, &k, (int)sizeof k, size, size, paintSpriteSlot, &tex, &src)) {
+        drawRoundedRectFilled(r, rad, fill);
+        if (border) drawRoundedRectOutline(r, rad, *border);
+        geom_flush(renderer);
+        return;
+    }
+    const int dx[3] = { r.x, r.x + c, r.x + r.w - c }, dw[3] = { c, r.w - 2*c, c };
+    const int dy[3] = { r.y, r.y + c, r.y + r.h - c }, dh[3] = { c, r.h - 2*c, c };
+    const int sx[3] = { src.x, src.x + c, src.x + c + 1 }, sw[3] = { c, 1, c };
+    const int sy[3] = { src.y, src.y + c, src.y + c + 1 }, sh[3] = { c, 1, c };
+    for (int j = 0; j < 3; ++j)
+        for (int i = 0; i < 3; ++i) {
+            SDL_Rect s = { sx[i], sy[j], sw[i], sh[j] };
+            SDL_Rect d = { dx[i], dy[j], dw[i], dh[j] };
+            if (i == 1 && j == 1) {         // plain fill: cheaper than a stretched copy
+                setColor(opaque(fill));
+                SDL_RenderFillRect(renderer, &d);
+            } else {
+                SDL_RenderCopy(renderer, tex, &s, &d);
+            }
+        }
+}
+
+// grow < 1: the piece is still appearing (see drawSpriteGrowing)
+static void drawXIcon(SDL_Rect cell, int inset, int thickness, SDL_Color color, float grow)
+{
+    SpriteKey k = spriteKey(SPR_XICON, cell.w, cell.h, inset, thickness, color, color);
+    drawSpriteGrowing(&k, cell.x, cell.y, grow);
+}
+
+static void drawOIcon(SDL_Rect cell, int inset, int thickness, SDL_Color color, float grow)
+{
+    SpriteKey k = spriteKey(SPR_OICON, cell.w, cell.h, inset, thickness, color, color);
+    drawSpriteGrowing(&k, cell.x, cell.y, grow);
+}
+
+// Person icons for buttons
+static void drawPersonOutline(int x, int y, int size, int stroke,
+                              SDL_Color col, SDL_Color bg)
+{
+    SpriteKey k = spriteKey(SPR_PERSON, size + 2, size + 2, size, stroke, col, bg);
+    drawSprite(&k, x, y);
+}
+
+static void drawTwoPeopleOutline(int x, int y, int size, int stroke,
+                                 SDL_Color col, SDL_Color bg)
+{
+    // the back figure sits up and to the right of the front one
+    int up = (int)round(size * 0.08);
+    int w  = (int)round(size * 0.24) + (int)round(size * 0.86) + 2;
+    SpriteKey k = spriteKey(SPR_TWO_PEOPLE, w, up + size + 2, size, stroke, col, bg);
+    drawSprite(&k, x, y - up);
 }
 
 // Button drawing
@@ -474,11 +605,10 @@ static void drawButton(SDL_Rect r, const char* label, int hovered, ButtonIcon ic
 
     SDL_Rect shadow = { r.x, r.y + 2, r.w, r.h };
     SDL_Color shadowCol = {0,0,0,55};
-    drawRoundedRectFilled(shadow, radius + 1, shadowCol);
+    drawRoundedCard(shadow, radius + 1, shadowCol, NULL);
 
     SDL_Color fill = hovered ? fillHover : fillNormal;
-    drawRoundedRectFilled(r, radius, fill);
-    drawRoundedRectOutline(r, radius, borderColor);
+    drawRoundedCard(r, radius, fill, &borderColor);
 
     int pad = 14;
     int iconBox = r.h - pad*2;
@@ -493,7 +623,7 @@ static void drawButton(SDL_Rect r, const char* label, int hovered, ButtonIcon ic
     else if (icon == ICON_DUO)
         drawTwoPeopleOutline(iconRect.x, iconRect.y, iconRect.w, stroke, black, fill);
 
-    SDL_Texture* txt = createTextTexture(label, font, labelColor);
+    SDL_Texture* txt = getTextTexture(label, font, labelColor);
     if (!txt) return;
     int tw, th;
     SDL_QueryTexture(txt, NULL, NULL, &tw, &th);
@@ -504,46 +634,6 @@ static void drawButton(SDL_Rect r, const char* label, int hovered, ButtonIcon ic
 
     SDL_Rect tdst = { textLeft, r.y + (r.h - th)/2, tw, th };
     SDL_RenderCopy(renderer, txt, NULL, &tdst);
-    SDL_DestroyTexture(txt);
-}
-
-// ------------- GET DEVICE STATS HELPER FUNCTIONS----------
-// -------------GET MEMORY PROCESS//GET MEMMORY USAGE-------------
-static size_t get_process_memory_kb(void)//RETURNS MEMORY USAGE FOR TTT.EXE ONLY
-{
-    PROCESS_MEMORY_COUNTERS_EX pmc;
-    if (GetProcessMemoryInfo(GetCurrentProcess(),
-(PROCESS_MEMORY_COUNTERS *)&pmc,
-                             sizeof(pmc))) {
-        return (size_t)(pmc.WorkingSetSize / 1024); // KILOBYTES
-    }
-    return 0;
-}
-
-// -------------GET THE PREVIOUS GAME INDEX FROM THE GAME COLUMN
-int get_last_game_number(const char *filename)
-{
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        // file doesn't exist yet
-        return 0;
-    }
-
-    char buf[512];
-    int last_game = 0;
-
-    // Read line by line, remember the last valid game number
-    // ignore first line cus its header
-    while (fgets(buf, sizeof(buf), f)) {
-        int g = 0;
-        // Try to parse the first integer before the first comma
-        if (sscanf(buf, "%d,", &g) == 1) {
-            last_game = g;
-        }
-    }
-
-    fclose(f);
-    return last_game;
 }
 
 //------------ INITALIZE LOGGING FILES FOR bot_metrics.csv------------
@@ -551,295 +641,236 @@ static void init_metrics_logging(void)
 {
     const char *metrics_filename = "bot_metrics.csv";
 
-    // get last game number in existing file 
-    int last_game = get_last_game_number(metrics_filename);
+    // click-to-photon rows (inputlat.c) go through the same writer thread
+    metrics_log_open_clicks("input_latency.csv",
+                            "game,ply,bot,queue_us,handle_us,update_us,ai_us,render_us,present_us,anim_us,total_us\n");
+
+    // open for appending (header goes into a new file), start the writer
+    // thread and get the last game number (read from the end of the file)
+    int last_game = 0;
+    metrics_log_open(metrics_filename,
+                     "game,move,bot,time_taken_per_move,process_memory_kb,mem_diff,"
+                     "peak_memory_kb,user_cpu_us,sys_cpu_us,vol_ctx_switches,invol_ctx_switches,nodes\n",
+                     &last_game);
     gameIndex = last_game + 1;   // + to last game value
     moveIndex = 0;
 
-    // 2. Open file in append mode
-    //    If file is brand new, we need to write the header once.
-    FILE *test = fopen(metrics_filename, "r");
-    int file_exists = (test != NULL);
-    if (test) fclose(test);
-
-    metricsLog = fopen(metrics_filename, file_exists ? "a" : "w");
-    if (metricsLog && !file_exists) {
-        // New file: write header
-        fprintf(metricsLog, "game,move,bot,time_taken_per_move,process_memory_kb,mem_diff\n");
-        fflush(metricsLog);
-    }
+    // this session's per-bot latency percentiles -> bot_latency.* at exit
+    latency_export_at_exit("bot_latency");
 }
 
 
 
-// ---------- Mode menu (main menu) ----------
-
-
-// Drawing mode buttons in main menu
-static int modeMenu(void) {
-    SDL_Event event;
+// ------------ Scenes ------------
+// Every screen (menus, game, playback) is a Scene on a stack, run by the
+// one loop in runScenes(): it sleeps until there is input or the top
+// scene says a frame is due, hands events to the top scene, and redraws
+// it through redrawScene() (the retained scene texture, only the dirty
+// part when that is all that changed). Pushing or popping a scene just
+// asks for a full redraw; textures and caches carry over.
+typedef struct Scene Scene;
+
+typedef struct {
+    SDL_Rect r;
+    const char *label;
+    ButtonIcon icon;
+    int plain;                  // label text only, centred at r.y (r is sized when drawn)
+} MenuButton;
+
+struct Scene {
+    const char *name;                                   // trace zone of its frames
+    void (*enter)(Scene *s);                            // on push (optional)
+    void (*event)(Scene *s, const SDL_Event *e);
+    void (*update)(Scene *s, Uint32 now);               // each frame before drawing (optional)
+    int  (*due)(Scene *s, Uint32 now);                  // ms until a frame is needed without input, -1 never (optional)
+    void (*draw)(Scene *s);                             // whole screen; honours the clip rect
+    // menu scenes
+    const char *title;
+    MenuButton *buttons;
+    int nButtons;
+    void (*pick)(int button);
+    int hover;                                          // button under the mouse, -1 = none
+};
+
+#define SCENE_DEPTH 8
+static Scene *scenes[SCENE_DEPTH];
+static int nScenes = 0;
+
+static void scene_push(Scene *s)
+{
+    if (nScenes == SCENE_DEPTH) return;
+    scenes[nScenes++] = s;
+    if (s->enter) s->enter(s);
+    needsRedraw = 1;
+}
 
-    const int btnW = WINDOW_WIDTH - 120;
-    const int btnH = 64;
-    SDL_Rect soloBtn  = { (WINDOW_WIDTH - btnW)/2, WINDOW_HEIGHT/2 - btnH - 12, btnW, btnH };
-    SDL_Rect duoBtn   = { (WINDOW_WIDTH - btnW)/2, WINDOW_HEIGHT/2 + 12,          btnW, btnH };
-    SDL_Rect playbackBtn= { (WINDOW_WIDTH - btnW)/2, WINDOW_HEIGHT/2 + btnH + 36,   btnW, btnH };//PLAYBACK BTN
-    SDL_Rect themeBtn = { WINDOW_WIDTH - 140, 20, 120, 40 }; // top-right
+static void scene_pop(void)
+{
+    if (nScenes > 0) nScenes--;
+    needsRedraw = 1;
+}
 
-    for (;;) {
-        setColor(getBackgroundColor());
-        SDL_RenderClear(renderer);
+static void startSession(void);
 
-        // title
-        SDL_Texture* title = createTextTexture("Tic-Tac-Toe", font, getTextColor());
-        if (title) {
-            int tw, th;
-            SDL_QueryTexture(title, NULL, NULL, &tw, &th);
-            SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 80, tw, th };
-            SDL_RenderCopy(renderer, title, NULL, &tpos);
-            SDL_DestroyTexture(title);
-        }
+// ---------- Menus ----------
+#define MENU_BTN_W   (WINDOW_WIDTH - 120)
+#define MENU_BTN_H   64
+#define MENU_BTN_X   ((WINDOW_WIDTH - MENU_BTN_W)/2)
+#define MENU_TOP     (WINDOW_HEIGHT/2 - MENU_BTN_H - 12)
 
-        int mx, my; SDL_GetMouseState(&mx, &my);
-
-        //functions for hover feature
-        int hSolo  = (mx>=soloBtn.x  && mx<=soloBtn.x+soloBtn.w  &&
-                      my>=soloBtn.y  && my<=soloBtn.y+soloBtn.h);
-        int hDuo   = (mx>=duoBtn.x   && mx<=duoBtn.x+duoBtn.w   &&
-                      my>=duoBtn.y   && my<=duoBtn.y+duoBtn.h);
-        int hTheme = (mx>=themeBtn.x && mx<=themeBtn.x+themeBtn.w &&
-                      my>=themeBtn.y && my<=themeBtn.y+themeBtn.h);
-        int hPlayback = (mx>=playbackBtn.x && mx<=playbackBtn.x+playbackBtn.w &&
-                 my>=playbackBtn.y && my<=playbackBtn.y+playbackBtn.h);
-
-
-        drawButton(soloBtn,  "Play Solo",          hSolo,  ICON_SOLO);
-        drawButton(duoBtn,   "Play with a friend", hDuo,   ICON_DUO);
-        drawButton(playbackBtn, "Playback", hPlayback, ICON_NONE);
-        drawButton(themeBtn, "Theme",              hTheme, ICON_NONE);
-
-        SDL_RenderPresent(renderer);
-
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) return 0;
-            //MAPS THE X AND Y COORDINATES TO THE BUTTON
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int x = event.button.x, y = event.button.y;
-                if (x>=themeBtn.x && x<=themeBtn.x+themeBtn.w &&
-                    y>=themeBtn.y && y<=themeBtn.y+themeBtn.h) {
-                    Theme chosen = themeMenu();
-                    if (chosen == THEME_DARK || chosen == THEME_FUN)
-                        currentTheme = chosen;
-                }
-                //SINGLEPLAYER MODE CLICK
-                if (x>=soloBtn.x && x<=soloBtn.x+soloBtn.w &&
-                    y>=soloBtn.y && y<=soloBtn.y+soloBtn.h)  return MODE_SP;
-                //MULTIPLAYER MODE CLICK
-                if (x>=duoBtn.x  && x<=duoBtn.x+duoBtn.w  &&
-                    y>=duoBtn.y  && y<=duoBtn.y+duoBtn.h)   return MODE_MP;
-                
-                    // PLAYBACK CLICK
-                if (x>=playbackBtn.x && x<=playbackBtn.x+playbackBtn.w && y>=playbackBtn.y && y<=playbackBtn.y+playbackBtn.h) {
-                    // IF PLAYBACK DATA EXIST
-                if (playback_has_last_game()) {
-                    playbackScreen();
-                } 
-                
-                else { //NO RECORDED DATA LAST GAME
-                    SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Playback", "No completed game to playback yet.", window);
-                }
-            }           
-
-            }
-        }
-        SDL_Delay(16);
+static int menuButtonAt(const Scene *s, int x, int y)
+{
+    for (int i = 0; i < s->nButtons; ++i) {
+        SDL_Rect r = s->buttons[i].r;
+        if (x>=r.x && x<=r.x+r.w && y>=r.y && y<=r.y+r.h) return i;
     }
+    return -1;
 }
 
-// background theme selection
-static Theme themeMenu(void) {
-    SDL_Event event;
-
-    const int btnW = WINDOW_WIDTH - 120;
-    const int btnH = 64;
-    const int centerX = (WINDOW_WIDTH - btnW)/2;
-    const int startY  = WINDOW_HEIGHT/2 - btnH - 12;
-
-    SDL_Rect darkBtn = { centerX, startY,             btnW, btnH };
-    SDL_Rect funBtn  = { centerX, startY + btnH + 24, btnW, btnH };
-
-    for (;;) {
-        // Use current theme's background / text
-        setColor(getBackgroundColor());
-        SDL_RenderClear(renderer);
-
-        SDL_Texture* title = createTextTexture("Select Theme", font, getTextColor());
-        if (title) {
-            int tw, th;
-            SDL_QueryTexture(title, NULL, NULL, &tw, &th);
-            SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 80, tw, th };
-            SDL_RenderCopy(renderer, title, NULL, &tpos);
-            SDL_DestroyTexture(title);
-        }
-
-        int mx, my; SDL_GetMouseState(&mx, &my);
-        int hDark = (mx>=darkBtn.x && mx<=darkBtn.x+darkBtn.w &&
-                     my>=darkBtn.y && my<=darkBtn.y+darkBtn.h);
-        int hFun  = (mx>=funBtn.x  && mx<=funBtn.x +funBtn.w  &&
-                     my>=funBtn.y  && my<=funBtn.y +funBtn.h);
-
-        drawButton(darkBtn, "Dark Theme", hDark, ICON_NONE);
-        drawButton(funBtn,  "Fun Theme",  hFun,  ICON_NONE);
-
-        SDL_RenderPresent(renderer);
+static void drawMenu(Scene *s)
+{
+    setColor(getBackgroundColor());
+    SDL_RenderFillRect(renderer, NULL);     // RenderClear would ignore the clip rect
+
+    SDL_Texture* title = getTextTexture(s->title, font, getTextColor());
+    if (title) {
+        int tw, th;
+        SDL_QueryTexture(title, NULL, NULL, &tw, &th);
+        SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 80, tw, th };
+        SDL_RenderCopy(renderer, title, NULL, &tpos);
+    }
 
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) return currentTheme;
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int x = event.button.x, y = event.button.y;
-                if (x>=darkBtn.x && x<=darkBtn.x+darkBtn.w &&
-                    y>=darkBtn.y && y<=darkBtn.y+darkBtn.h) {
-                    return THEME_DARK;
-                }
-                if (x>=funBtn.x && x<=funBtn.x+funBtn.w &&
-                    y>=funBtn.y && y<=funBtn.y+funBtn.h) {
-                    return THEME_FUN;
-                }
-            }
+    int mx, my; SDL_GetMouseState(&mx, &my);
+    s->hover = menuButtonAt(s, mx, my);
+    for (int i = 0; i < s->nButtons; ++i) {
+        MenuButton *b = &s->buttons[i];
+        if (b->plain) {
+            SDL_Texture *t = getTextTexture(b->label, font, getTextColor());
+            if (!t) continue;
+            SDL_QueryTexture(t, NULL, NULL, &b->r.w, &b->r.h);
+            b->r.x = WINDOW_WIDTH/2 - b->r.w/2;
+            SDL_RenderCopy(renderer, t, NULL, &b->r);
+        } else {
+            drawButton(b->r, b->label, i == s->hover, b->icon);
         }
-        SDL_Delay(16);
     }
 }
 
-// difficulty selection
-static Difficulty difficultyMenu(void) {
-    SDL_Event event;
-
-    const int btnW = WINDOW_WIDTH - 120;
-    const int btnH = 64;
-    const int centerX = (WINDOW_WIDTH - btnW)/2;
-    const int startY  = WINDOW_HEIGHT/2 - btnH - 12;
-
-    SDL_Rect easyBtn   = { centerX, startY,               btnW, btnH };
-    SDL_Rect medBtn    = { centerX, startY + btnH + 24,   btnW, btnH };
-    SDL_Rect hardBtn   = { centerX, startY + 2*(btnH+24), btnW, btnH };
-
-    const int backW = 120, backH = 46, pad = 24;
-    SDL_Rect backBtn = { WINDOW_WIDTH - backW - pad, WINDOW_HEIGHT - backH - pad,
-                         backW, backH };
-
-    for (;;) {
-        setColor(getBackgroundColor());
-        SDL_RenderClear(renderer);
-
-        SDL_Texture* title = createTextTexture("Select Difficulty", font, getTextColor());
-        if (title) {
-            int tw, th;
-            SDL_QueryTexture(title, NULL, NULL, &tw, &th);
-            SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 80, tw, th };
-            SDL_RenderCopy(renderer, title, NULL, &tpos);
-            SDL_DestroyTexture(title);
+static void menuEvent(Scene *s, const SDL_Event *e)
+{
+    if (e->type == SDL_MOUSEMOTION) {
+        int h = menuButtonAt(s, e->motion.x, e->motion.y);
+        if (h != s->hover) {                // old and new button, with their shadows
+            if (s->hover >= 0) { SDL_Rect r = s->buttons[s->hover].r; markDirty((SDL_Rect){ r.x, r.y, r.w + 1, r.h + 3 }); }
+            if (h >= 0)        { SDL_Rect r = s->buttons[h].r;        markDirty((SDL_Rect){ r.x, r.y, r.w + 1, r.h + 3 }); }
+            s->hover = h;
         }
+    }
+    if (e->type == SDL_MOUSEBUTTONDOWN) {
+        int i = menuButtonAt(s, e->button.x, e->button.y);
+        if (i >= 0) s->pick(i);
+    }
+}
 
-        int mx, my; SDL_GetMouseState(&mx, &my);
-        int hEasy = (mx>=easyBtn.x && mx<=easyBtn.x+easyBtn.w &&
-                     my>=easyBtn.y && my<=easyBtn.y+easyBtn.h);
-        int hMed  = (mx>=medBtn.x  && mx<=medBtn.x +medBtn.w  &&
-                     my>=medBtn.y  && my<=medBtn.y +medBtn.h);
-        int hHard = (mx>=hardBtn.x && mx<=hardBtn.x+hardBtn.w &&
-                     my>=hardBtn.y && my<=hardBtn.y+hardBtn.h);
-        int hBack = (mx>=backBtn.x && mx<=backBtn.x+backBtn.w &&
-                     my>=backBtn.y && my<=backBtn.y+backBtn.h);
-
-        drawButton(easyBtn, "Easy (Naive Bayes)",      hEasy, ICON_SOLO);
-        drawButton(medBtn,  "Medium (Minimax)",        hMed,  ICON_SOLO);
-        drawButton(hardBtn, "Hard (Perfect Minimax)",  hHard, ICON_SOLO);
-        drawButton(backBtn, "Back",                    hBack, ICON_NONE);
-
-        SDL_RenderPresent(renderer);
+static Scene themeScene, difficultyScene, sideScene, playbackScene;
 
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                SDL_QUIT;
-                exit(0);
-            }
+// Main menu
+static MenuButton mainButtons[] = {
+    { { MENU_BTN_X, WINDOW_HEIGHT/2 - MENU_BTN_H - 12, MENU_BTN_W, MENU_BTN_H }, "Play Solo",          ICON_SOLO, 0 },
+    { { MENU_BTN_X, WINDOW_HEIGHT/2 + 12,              MENU_BTN_W, MENU_BTN_H }, "Play with a friend", ICON_DUO,  0 },
+    { { MENU_BTN_X, WINDOW_HEIGHT/2 + MENU_BTN_H + 36, MENU_BTN_W, MENU_BTN_H }, "Playback",           ICON_NONE, 0 },
+    { { WINDOW_WIDTH - 140, 20, 120, 40 },                                       "Theme",              ICON_NONE, 0 },  // top-right
+};
 
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int x = event.button.x, y = event.button.y;
-                if (x>=easyBtn.x && x<=easyBtn.x+easyBtn.w &&
-                    y>=easyBtn.y && y<=easyBtn.y+easyBtn.h)  return DIFF_EASY;
-                if (x>=medBtn.x  && x<=medBtn.x +medBtn.w  &&
-                    y>=medBtn.y  && y<=medBtn.y +medBtn.h)  return DIFF_MEDIUM;
-                if (x>=hardBtn.x && x<=hardBtn.x+hardBtn.w &&
-                    y>=hardBtn.y && y<=hardBtn.y+hardBtn.h) return DIFF_HARD;
-                if (x>=backBtn.x && x<=backBtn.x+backBtn.w &&
-                    y>=backBtn.y && y<=backBtn.y+backBtn.h) return DIFF_BACK;
-            }
-        }
-        SDL_Delay(16);
+static void mainMenuPick(int i)
+{
+    switch (i) {
+    case 0:                             // singleplayer: difficulty, then side
+        scene_push(&difficultyScene);
+        break;
+    case 1:
+        gameMode = MODE_MP;
+        startSession();
+        break;
+    case 2:
+        if (playback_has_last_game())
+            scene_push(&playbackScene);
+        else                            // no recorded game yet
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Playback", "No completed game to playback yet.", window);
+        break;
+    case 3:
+        scene_push(&themeScene);
+        break;
     }
 }
 
-// player icon selection
-static PlayerSide sideMenu(void) {
-    SDL_Event event;
-
-    for(;;){
-        setColor(getBackgroundColor());
-        SDL_RenderClear(renderer);
+static Scene mainMenuScene = {
+    "modeMenu", NULL, menuEvent, NULL, NULL, drawMenu,
+    "Tic-Tac-Toe", mainButtons, 4, mainMenuPick, -1
+};
 
-        SDL_Texture *t0 = createTextTexture("Choose Your Side", font, getTextColor());
-        SDL_Texture *t1 = createTextTexture("Play as X",        font, getTextColor());
-        SDL_Texture *t2 = createTextTexture("Play as O",        font, getTextColor());
-
-        int w0,h0,w1,h1,w2,h2;
-        if (t0) SDL_QueryTexture(t0,NULL,NULL,&w0,&h0);
-        else { w0=h0=0; }
-        if (t1) SDL_QueryTexture(t1,NULL,NULL,&w1,&h1);
-        else { w1=h1=0; }
-        if (t2) SDL_QueryTexture(t2,NULL,NULL,&w2,&h2);
-        else { w2=h2=0; }
+// background theme selection
+static MenuButton themeButtons[] = {
+    { { MENU_BTN_X, MENU_TOP,                  MENU_BTN_W, MENU_BTN_H }, "Dark Theme", ICON_NONE, 0 },
+    { { MENU_BTN_X, MENU_TOP + MENU_BTN_H + 24, MENU_BTN_W, MENU_BTN_H }, "Fun Theme",  ICON_NONE, 0 },
+};
 
-        SDL_Rect r0={WINDOW_WIDTH/2-w0/2, 80,  w0,h0};
-        SDL_Rect r1={WINDOW_WIDTH/2-w1/2, 160, w1,h1};
-        SDL_Rect r2={WINDOW_WIDTH/2-w2/2, 220, w2,h2};
+static void themeMenuPick(int i)
+{
+    Theme chosen = (i == 0) ? THEME_DARK : THEME_FUN;
+    if (chosen != currentTheme) {
+        currentTheme = chosen;
+        textcache_clear();   // labels and shapes were rendered in the old theme's colours
+        sprite_clear();
+    }
+    scene_pop();
+}
 
-        if (t0) SDL_RenderCopy(renderer,t0,NULL,&r0);
-        if (t1) SDL_RenderCopy(renderer,t1,NULL,&r1);
-        if (t2) SDL_RenderCopy(renderer,t2,NULL,&r2);
+static Scene themeScene = {
+    "themeMenu", NULL, menuEvent, NULL, NULL, drawMenu,
+    "Select Theme", themeButtons, 2, themeMenuPick, -1
+};
 
-        SDL_RenderPresent(renderer);
+// difficulty selection
+static MenuButton difficultyButtons[] = {
+    { { MENU_BTN_X, MENU_TOP,                      MENU_BTN_W, MENU_BTN_H }, "Easy (Naive Bayes)",     ICON_SOLO, 0 },
+    { { MENU_BTN_X, MENU_TOP + MENU_BTN_H + 24,    MENU_BTN_W, MENU_BTN_H }, "Medium (Minimax)",       ICON_SOLO, 0 },
+    { { MENU_BTN_X, MENU_TOP + 2*(MENU_BTN_H + 24), MENU_BTN_W, MENU_BTN_H }, "Hard (Perfect Minimax)", ICON_SOLO, 0 },
+    { { WINDOW_WIDTH - 120 - 24, WINDOW_HEIGHT - 46 - 24, 120, 46 },         "Back",                   ICON_NONE, 0 },
+};
+
+static void difficultyMenuPick(int i)
+{
+    static const Difficulty levels[3] = { DIFF_EASY, DIFF_MEDIUM, DIFF_HARD };
+    if (i == 3) { scene_pop(); return; }     // back to the main menu
+    gameMode = MODE_SP;
+    aiDiff = levels[i];
+    scene_push(&sideScene);
+}
 
-        while(SDL_PollEvent(&event)){
-            if(event.type==SDL_QUIT) {
-                SDL_Quit();
-                exit(0);
+static Scene difficultyScene = {
+    "difficultyMenu", NULL, menuEvent, NULL, NULL, drawMenu,
+    "Select Difficulty", difficultyButtons, 4, difficultyMenuPick, -1
+};
 
+// player icon selection
+static MenuButton sideButtons[] = {
+    { { 0, 160, 0, 0 }, "Play as X", ICON_NONE, 1 },
+    { { 0, 220, 0, 0 }, "Play as O", ICON_NONE, 1 },
+};
 
-            }
-            if(event.type==SDL_MOUSEBUTTONDOWN){
-                int mx=event.button.x,my=event.button.y;
-                if(mx>=r1.x&&mx<=r1.x+r1.w&&my>=r1.y&&my<=r1.y+r1.h){
-                    if (t0) SDL_DestroyTexture(t0);
-                    if (t1) SDL_DestroyTexture(t1);
-                    if (t2) SDL_DestroyTexture(t2);
-                    return SIDE_X;
-                }
-                if(mx>=r2.x&&mx<=r2.x+r2.w&&my>=r2.y&&my<=r2.y+r2.h){
-                    if (t0) SDL_DestroyTexture(t0);
-                    if (t1) SDL_DestroyTexture(t1);
-                    if (t2) SDL_DestroyTexture(t2);
-                    return SIDE_O;
-                }
-            }
-        }
-        if (t0) SDL_DestroyTexture(t0);
-        if (t1) SDL_DestroyTexture(t1);
-        if (t2) SDL_DestroyTexture(t2);
-        SDL_Delay(16);
-    }
+static void sideMenuPick(int i)
+{
+    playerSide = (i == 0) ? SIDE_X : SIDE_O;
+    aiPiece = (playerSide==SIDE_X) ? O : X; // assign icon to player based on pref
+    startSession();
 }
 
+static Scene sideScene = {
+    "sideMenu", NULL, menuEvent, NULL, NULL, drawMenu,
+    "Choose Your Side", sideButtons, 2, sideMenuPick, -1
+};
+
 // updates score of current game
 static void updateScores(int winner) {
     if (winner==X) scoreX++;
@@ -869,74 +900,138 @@ static int isBoardFull(void) {
     return 1;
 }
 
-// renders display message
-static void displayMessage(const char* message) {
-    SDL_Texture* msgTex = createTextTexture(message, font, getTextColor());
-    if (!msgTex) return;
+// Result banner, centred in the window as the old blocking message was
+static SDL_Rect bannerRect(void)
+{
+    SDL_Rect r = {0};
+    SDL_Texture *tex = resultText[0] ? getTextTexture(resultText, font, getTextColor()) : NULL;
+    if (!tex) return r;
+    int w, h;
+    SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+    r.w = w + 56;
+    r.h = h + 28;
+    r.x = (WINDOW_WIDTH  - r.w) / 2;
+    r.y = (WINDOW_HEIGHT - r.h) / 2;
+    return r;
+}
+
+static void drawResultBanner(float alpha)
+{
+    SDL_Rect r = bannerRect();
+    SDL_Texture *tex = getTextTexture(resultText, font, getTextColor());
+    if (r.w == 0 || !tex || alpha <= 0.0f) return;
+    Uint8 a = (Uint8)(255.0f * (alpha > 1.0f ? 1.0f : alpha));
+    SDL_Color fill   = (currentTheme == THEME_FUN) ? funCellFill : cardFill;
+    SDL_Color border = (currentTheme == THEME_FUN) ? (SDL_Color){0,0,0,255} : cardBorder;
+    fill.a = border.a = a;
+    geom_rounded_rect(r, 14.0f, fill);
+    geom_rounded_rect_outline(r, 14.0f, 1.0f, border);
+    geom_flush(renderer);                   // with the win line, if any
 
     int w, h;
-    SDL_QueryTexture(msgTex, NULL, NULL, &w, &h);
-    SDL_Rect dest = { (WINDOW_WIDTH  - w) / 2,
-                      (WINDOW_HEIGHT - h) / 2,
-                      w, h };
+    SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+    SDL_Rect dest = { r.x + (r.w - w) / 2, r.y + (r.h - h) / 2, w, h };
+    SDL_SetTextureAlphaMod(tex, a);         // shared with the text cache
+    SDL_RenderCopy(renderer, tex, NULL, &dest);
+    SDL_SetTextureAlphaMod(tex, 255);
+}
 
-    SDL_RenderCopy(renderer, msgTex, NULL, &dest);
-    SDL_RenderPresent(renderer);
+// Game over: score it and start the win line and banner; the board stays
+// until startNextRound()
+static void finishRound(int winner)
+{
+    Uint32 now = SDL_GetTicks();
+    playback_finalize_game(gameMode, aiDiff);
+    updateScores(winner);
+
+    if (winner == X)
+        snprintf(resultText, sizeof resultText, "%s", gameMode == MODE_SP
+                 ? ((playerSide == SIDE_X) ? "You Win!" : "CPU (X) Wins!")
+                 : "Player X Wins!");
+    else if (winner == O)
+        snprintf(resultText, sizeof resultText, "%s", gameMode == MODE_SP
+                 ? ((playerSide == SIDE_O) ? "You Win!" : "CPU (O) Wins!")
+                 : "Player O Wins!");
+    else
+        snprintf(resultText, sizeof resultText, "Draw!");
+
+    Uint32 lineMs = winner ? WINLINE_MS : 0;
+    if (winner) anim_start(ANIM_WIN_LINE, now, 0, WINLINE_MS, EASE_OUT);
+    anim_start(ANIM_BANNER_IN,  now, lineMs, BANNER_FADE_MS, EASE_OUT);
+    anim_start(ANIM_BANNER_OUT, now, lineMs + BANNER_MS - BANNER_FADE_MS, BANNER_FADE_MS, EASE_IN_OUT);
+
+    // ensures loser will start first in the next game
+    if (winner == X) firstPlayer = 2;
+    else if (winner == O) firstPlayer = 1;
+
+    // reset game index and move when game ends
+    gameIndex++;
+    moveIndex = 0;
+    roundOver = 1;
+    needsRedraw = 1;    // scores
+}
 
-    SDL_DestroyTexture(msgTex);
-    SDL_Delay(1100);
+// Clears the board for the next game (after finishRound, Reset or Back)
+static void startNextRound(void)
+{
+    anim_stop_all();
+    roundOver = 0;
+    currentPlayer = firstPlayer;
+    initBoard();
+    needsRedraw = 1;
 }
 
 static void botMove(void) {
     moveIndex++;
-    size_t mem_before = get_process_memory_kb();
+    ProcMetrics before, after;
+    proc_metrics_sample(&before);
     Uint64 Time_b4_AI_move = SDL_GetPerformanceCounter();
 
     int move = -1;
+    long long nodes = -1;       // positions searched; the Naive Bayes bot doesn't search
     const char *botName = "Unknown";
 
+    TRACE_BEGIN("botMove", "engine");
     if (aiDiff == DIFF_EASY) {
         botName = "NaiveBayes";
         move = bestMove_naive_bayes_for(board, aiPiece);
     } else if (aiDiff == DIFF_MEDIUM) {
         botName = "MinimaxDepth3";
-        move = bestMove_minimax_for(board, aiPiece, 3, 20);
+        move = bestMove_minimax_nodes(board, aiPiece, 3, 20, &nodes);
     } else {
         botName = "MinimaxPerfect";
-        move = bestMove_minimax_for(board, aiPiece, -1, 0);
+        move = bestMove_minimax_nodes(board, aiPiece, -1, 0, &nodes);
     }
+    TRACE_END();
 
     Uint64 Time_after_AI_move = SDL_GetPerformanceCounter();
-    size_t mem_after          = get_process_memory_kb();
+    proc_metrics_sample(&after);
 
     // Time taken for this move in microseconds
     double time_taken_per_move =
         (double)(Time_after_AI_move - Time_b4_AI_move) * 1e6
         / (double)SDL_GetPerformanceFrequency();
 
-    // Absolute process memory after this move (KB)
-    size_t process_memory_kb = mem_after;
-
-    // NEW: mem_diff = difference vs previous AI move's process_memory_kb
-    long mem_diff = 0;
-    if (last_process_memory_kb != 0) {
-        mem_diff = (long)process_memory_kb - (long)last_process_memory_kb;
-    }
-    last_process_memory_kb = process_memory_kb;
-
-    if (metricsLog) {
-        // CSV row: game,move,bot,time_taken_per_move,process_memory_kb,mem_diff
-        fprintf(metricsLog,
-                "%d,%d,%s,%.0f,%zu,%ld\n",
-                gameIndex, moveIndex, botName,
-                time_taken_per_move, process_memory_kb, mem_diff);
-        fflush(metricsLog);
-    }
+    // mem_diff = difference vs previous AI move's process_memory_kb,
+    // so 'before' carries that instead of the pre-move RSS
+    before.rssKb = last_process_memory_kb ? last_process_memory_kb : after.rssKb;
+    last_process_memory_kb = after.rssKb > 0 ? after.rssKb : 0;
+
+    // CSV row: game,move,bot,time_taken_per_move,process_memory_kb,mem_diff,
+    // peak_memory_kb, then CPU time and context switches spent on this move
+    // and the nodes searched (queued; the metrics thread does the writing)
+    TRACE_BEGIN("metrics_log_move", "logging");
+    metrics_log_move(gameIndex, moveIndex, botName, time_taken_per_move, nodes, &after, &before);
+    latency_record(botName, time_taken_per_move);
+    hud_bot_move(botName, time_taken_per_move, nodes);
+    inputlat_bot_move(botName, time_taken_per_move);   // replying to a click in this frame
+    TRACE_END();
 
     if (move != -1) {
         int i = move / 3, j = move % 3;
         board[i][j] = aiPiece;
         playback_record_move(i, j, aiPiece);  
+        anim_start(ANIM_PLACE + move, SDL_GetTicks(), 0, PLACE_MS, EASE_OUT);
         needsRedraw = 1;
     }
 }
@@ -948,8 +1043,20 @@ static void botMove(void) {
 
 // in-game rendering
 static void renderGame(void) {
+    TRACE_BEGIN("renderGame", "frame");
+    drawGame();
+    TRACE_BEGIN("SDL_RenderPresent", "frame");
+    SDL_RenderPresent(renderer);
+    TRACE_END();
+    needsRedraw = 0;
+    TRACE_END();
+}
+
+// Draws the game screen into the current target (honours the clip rect)
+static void drawGame(void) {
+    TRACE_BEGIN("drawGame", "frame");
     setColor(getBackgroundColor());
-    SDL_RenderClear(renderer);
+    SDL_RenderFillRect(renderer, NULL);     // RenderClear would ignore the clip rect
 
     int y = PADDING_TOP;
 
@@ -963,21 +1070,19 @@ static void renderGame(void) {
         snprintf(buf, sizeof(buf), "%s", m);
         modeText = buf;
     }
-    SDL_Texture* modeTex = createTextTexture(modeText, font, getTextColor());
+    SDL_Texture* modeTex = getTextTexture(modeText, font, getTextColor());
     if (modeTex) {
         int mw, mh;
         SDL_QueryTexture(modeTex, NULL, NULL, &mw, &mh);
         SDL_Rect modePos = { (WINDOW_WIDTH-mw)/2, y, mw, mh };
         SDL_RenderCopy(renderer, modeTex, NULL, &modePos);
-        SDL_DestroyTexture(modeTex);
 
-        SDL_Texture* backTex = createTextTexture("Back", font, getTextColor());
+        SDL_Texture* backTex = getTextTexture("Back", font, getTextColor());
         if (backTex) {
             int bw,bh;
             SDL_QueryTexture(backTex,NULL,NULL,&bw,&bh);
             backButton = (SDL_Rect){ WINDOW_WIDTH - bw - 16, y, bw, bh };
             SDL_RenderCopy(renderer, backTex, NULL, &backButton);
-            SDL_DestroyTexture(backTex);
         }
         y += mh + MODE_BOTTOM_PAD;
     }
@@ -987,10 +1092,8 @@ static void renderGame(void) {
     SDL_Rect leftCard  = { (WINDOW_WIDTH/2) - cardW - gap/2, y, cardW, cardH };
     SDL_Rect rightCard = { (WINDOW_WIDTH/2) + gap/2,         y, cardW, cardH };
 
-    drawRoundedRectFilled(leftCard, 12, cardFill);
-    drawRoundedRectOutline(leftCard, 12, cardBorder);
-    drawRoundedRectFilled(rightCard, 12, cardFill);
-    drawRoundedRectOutline(rightCard, 12, cardBorder);
+    drawRoundedCard(leftCard, 12, cardFill, &cardBorder);
+    drawRoundedCard(rightCard, 12, cardFill, &cardBorder);
 
     int yourWins = scoreX, cpuWins = scoreO;
     if (gameMode==MODE_SP) {
@@ -1010,8 +1113,8 @@ static void renderGame(void) {
     // In fun theme score text should be white
     SDL_Color scoreCol = (currentTheme == THEME_FUN ? textLight : getTextColor());
 
-    SDL_Texture* lt = createTextTexture(leftText, font, scoreCol);
-    SDL_Texture* rt = createTextTexture(rightText, font, scoreCol);
+    SDL_Texture* lt = getTextTexture(leftText, font, scoreCol);
+    SDL_Texture* rt = getTextTexture(rightText, font, scoreCol);
     if (lt && rt) {
         int ltw,lth, rtw,rth;
         SDL_QueryTexture(lt,NULL,NULL,&ltw,&lth);
@@ -1021,8 +1124,6 @@ static void renderGame(void) {
         SDL_RenderCopy(renderer, lt, NULL, &lpos);
         SDL_RenderCopy(renderer, rt, NULL, &rpos);
     }
-    if (lt) SDL_DestroyTexture(lt);
-    if (rt) SDL_DestroyTexture(rt);
 
     y += cardH + SCOREBOXES_BOTTOM_PAD;
 
@@ -1035,13 +1136,12 @@ static void renderGame(void) {
     } else {
         turnText = (turnPiece==X) ? "Player X's Turn" : "Player O's Turn";
     }
-    SDL_Texture* ttex = createTextTexture(turnText, font, getTextColor());
+    SDL_Texture* ttex = getTextTexture(turnText, font, getTextColor());
     if (ttex) {
         int tw,th;
         SDL_QueryTexture(ttex,NULL,NULL,&tw,&th);
         SDL_Rect tpos = { (WINDOW_WIDTH-tw)/2, y, tw, th };
         SDL_RenderCopy(renderer, ttex, NULL, &tpos);
-        SDL_DestroyTexture(ttex);
         y += th + TURN_LABEL_BOTTOM_PAD;
     }
 
@@ -1069,14 +1169,13 @@ static void renderGame(void) {
         oIconColor = (SDL_Color){180, 60,  90,255 };
     }
 
-    drawRoundedRectFilled(boardRect, 16, boardFillUse);
-    drawRoundedRectOutline(boardRect, 16, boardBorderUse);
+    drawRoundedCard(boardRect, 16, boardFillUse, &boardBorderUse);
 
     int gx = boardRect.x + BOARD_PAD;
     int gy = boardRect.y + BOARD_PAD;
 
     Uint32 tick = SDL_GetTicks();
-    int blinkOn = ((tick / 400) % 2) == 0;   // ~2.5 blinks per second
+    int blinkOn = ((tick / HINT_BLINK_MS) % 2) == 0;   // ~1.25 blinks per second
 
     for (int r=0; r<3; ++r) {
         for (int c=0; c<3; ++c) {
@@ -1090,15 +1189,17 @@ static void renderGame(void) {
                 fill = hintFill;
             }
 
-            drawRoundedRectFilled(cell, 12, fill);
-            drawRoundedRectOutline(cell, 12, cellBorderUse);
+            drawRoundedCard(cell, 12, fill, &cellBorderUse);
 
             int inset  = 18;
             int stroke = 14;
+            float grow = anim_value(ANIM_PLACE + idx, tick);   // -1: not animating
+            if (grow < 0.0f) grow = 1.0f;
             if (board[r][c] == X)
-                drawXIcon(cell, inset, stroke, xIconColor);
+                drawXIcon(cell, inset, stroke, xIconColor, grow);
             else if (board[r][c] == O)
-                drawOIcon(cell, inset, stroke, oIconColor, cellFillUse);
+                drawOIcon(cell, inset, stroke, oIconColor, grow);
+            if (board[r][c] != EMPTY && grow >= 1.0f) inputlat_piece_shown(idx);
         }
     }
 
@@ -1113,177 +1214,1095 @@ static void renderGame(void) {
                   my>=resetButton.y && my<=resetButton.y+resetButton.h);
     drawButton(resetButton, "Reset Game", hReset, ICON_NONE);
 
+    // 6) Win line and result banner, over everything
+    if (roundOver) {
+        SDL_Color lineColor = (currentTheme == THEME_FUN) ? (SDL_Color){0,0,0,255} : getTextColor();
+        float line = anim_value(ANIM_WIN_LINE, tick);
+        if (line > 0.0f) drawWinLine(line, lineColor);
+        float in = anim_value(ANIM_BANNER_IN, tick), out = anim_value(ANIM_BANNER_OUT, tick);
+        if (in > 0.0f) drawResultBanner(in * (out > 0.0f ? 1.0f - out : 1.0f));
+        geom_flush(renderer);       // the line, when there's no banner yet
+    }
+
+    // 7) Performance overlay (F3), one cached texture
+    if (hudVisible) hud_draw(renderer, HUD_X, HUD_Y);
+    TRACE_END();
+}
+
+// Screen rect of board cell idx (0..8), as last drawn
+static SDL_Rect cellRect(int idx)
+{
+    SDL_Rect cell = { boardRect.x + BOARD_PAD + (idx % 3)*(CELL_SIZE + GRID_GAP),
+                      boardRect.y + BOARD_PAD + (idx / 3)*(CELL_SIZE + GRID_GAP),
+                      CELL_SIZE, CELL_SIZE };
+    return cell;
+}
+
+static void markDirty(SDL_Rect r)
+{
+    if (r.w <= 0 || r.h <= 0) return;
+    if (dirtyRect.w == 0) dirtyRect = r;
+    else SDL_UnionRect(&dirtyRect, &r, &dirtyRect);
+}
+
+// The one render path for every scene. The screen is kept in a target
+// texture, so when only dirtyRect changed (hint blink, button hover) just
+// that part is drawn again; the window gets a copy of the whole texture.
+// Does nothing if nothing changed.
+static SDL_Texture *sceneTex = NULL;
+
+static void redrawScene(Scene *s)
+{
+    if (!needsRedraw && dirtyRect.w == 0) return;
+    inputlat_render_start();
+    if (!sceneTex && SDL_RenderTargetSupported(renderer)) {
+        sceneTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                     WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (sceneTex) SDL_SetTextureBlendMode(sceneTex, SDL_BLENDMODE_NONE);
+        needsRedraw = 1;
+    }
+    TRACE_BEGIN("redrawScene", "frame");
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    if (sceneTex) {
+        SDL_SetRenderTarget(renderer, sceneTex);
+        if (!needsRedraw) SDL_RenderSetClipRect(renderer, &dirtyRect);
+    }
+    s->draw(s);                         // no render targets: all of it, to the window
+    if (sceneTex) {
+        SDL_RenderSetClipRect(renderer, NULL);
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, sceneTex, NULL, NULL);
+    }
+    TRACE_BEGIN("SDL_RenderPresent", "frame");
+    inputlat_present_start();
     SDL_RenderPresent(renderer);
+    inputlat_presented();               // a click's piece is on screen now
+    TRACE_END();
+    hud_frame((double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency());
     needsRedraw = 0;
+    dirtyRect.w = 0;
+    TRACE_END();
 }
 
-// playback screen rendering
-static void playbackScreen(void) {
-    if (!playback_has_last_game()) {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION,
-                                 "Playback",
-                                 "No completed game to playback yet.",
-                                 window);
-        return;
-    }
+// ---------- Game scene ----------
+static int resetHover = 0;
+static int hintBlinkOn = 0;
 
-    int playbackIndex = 0;
-    int maxMoves      = playback_get_move_count();
-    Cell pbBoard[3][3];
+static int humanTurnNow(void)
+{
+    return (gameMode == MODE_SP) &&
+           ((currentPlayer == 1) ? X : O) == ((playerSide == SIDE_X) ? X : O);
+}
 
-    SDL_Event event;
-    int viewing = 1;
+// Sleeps until there is input or something is due (hint blink, idle
+// hint, animation); never while the bot is to move.
+static int gameDue(Scene *s, Uint32 now)
+{
+    (void)s;
+    int timeout = -1;                       // ms; -1 = until input
+    int humanTurn = humanTurnNow();
+    if (hintIndex != -1)
+        timeout = HINT_BLINK_MS - (int)(now % HINT_BLINK_MS);
+    else if (humanTurn && lastHumanActivityTicks != 0 &&
+             now - lastHumanActivityTicks <= HINT_IDLE_MS)
+        timeout = (int)(lastHumanActivityTicks + HINT_IDLE_MS + 1 - now);
+    int due = anim_next_due(now);
+    if (due >= 0 && (timeout < 0 || due < timeout))
+        timeout = due;
+    if (hudVisible && (timeout < 0 || hud_next_due(now) < timeout))
+        timeout = hud_next_due(now);
+    if (gameMode == MODE_SP && !humanTurn && !roundOver)
+        timeout = 0;
+    return timeout;
+}
 
-    while (viewing) {
-        // Build board state for this step
-        playback_build_board_at_step(playbackIndex, pbBoard);
+static void gameEvent(Scene *s, const SDL_Event *event)
+{
+    (void)s;
+    if (event->type == SDL_MOUSEMOTION) {
+        int mx = event->motion.x, my = event->motion.y;
+        int h = (mx>=resetButton.x && mx<=resetButton.x+resetButton.w &&
+                 my>=resetButton.y && my<=resetButton.y+resetButton.h);
+        if (h != resetHover) {          // button plus its shadow
+            resetHover = h;
+            markDirty((SDL_Rect){ resetButton.x, resetButton.y, resetButton.w + 1, resetButton.h + 3 });
+        }
+    }
 
-        // Background based on current theme
-        setColor(getBackgroundColor());
-        SDL_RenderClear(renderer);
+    // F9: latency percentiles so far, to the console and bot_latency.*
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F9) {
+        latency_report(stdout);
+        latency_export("bot_latency");
+    }
 
-        // Title
-        SDL_Texture* title = createTextTexture("Playback - Last Game", font, getTextColor());
-        if (title) {
-            int tw, th;
-            SDL_QueryTexture(title, NULL, NULL, &tw, &th);
-            SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 40, tw, th };
-            SDL_RenderCopy(renderer, title, NULL, &tpos);
-            SDL_DestroyTexture(title);
-        }
+    // F3: performance overlay
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F3) {
+        if (hudVisible) markDirty(hud_rect(HUD_X, HUD_Y));
+        else hud_clear();               // rebuilt with fresh numbers below
+        hudVisible = !hudVisible;
+    }
 
-        // Step text: "Move X / N"
-        char stepBuf[64];
-        snprintf(stepBuf, sizeof(stepBuf), "Move %d / %d", playbackIndex, maxMoves);
-        SDL_Texture* stepTex = createTextTexture(stepBuf, font, getTextColor());
-        if (stepTex) {
-            int sw, sh;
-            SDL_QueryTexture(stepTex, NULL, NULL, &sw, &sh);
-            SDL_Rect spos = { (WINDOW_WIDTH - sw)/2, 80, sw, sh };
-            SDL_RenderCopy(renderer, stepTex, NULL, &spos);
-            SDL_DestroyTexture(stepTex);
+    if (event->type == SDL_MOUSEBUTTONDOWN) {
+        int mx = event->button.x, my = event->button.y;   // click behavaiour for mouse
+
+        // Back button: to the main menu, a new session starts from there
+        if (mx >= backButton.x && mx <= backButton.x + backButton.w &&
+            my >= backButton.y && my <= backButton.y + backButton.h) {
+            scene_pop();
+            return;
         }
 
-        // Board layout (same maths as renderGame)
-        int cardSide = 3*CELL_SIZE + 2*GRID_GAP + 2*BOARD_PAD;
-        boardRect.w = cardSide;
-        boardRect.h = cardSide;
-        boardRect.x = (WINDOW_WIDTH - boardRect.w)/2;
-        boardRect.y = WINDOW_HEIGHT/2 - boardRect.h/2;
-
-        SDL_Color boardFillUse   = boardFill;
-        SDL_Color boardBorderUse = boardBorder;
-        SDL_Color cellFillUse    = cellFill;
-        SDL_Color cellBorderUse  = cellBorder;
-
-        SDL_Color xIconColor = xColor;
-        SDL_Color oIconColor = oColor;
-
-        if (currentTheme == THEME_FUN) {
-            boardFillUse   = funBoardFill;
-            cellFillUse    = funCellFill;
-            SDL_Color black = (SDL_Color){0,0,0,255};
-            boardBorderUse = black;
-            cellBorderUse  = black;
-
-            xIconColor = (SDL_Color){ 20, 150,  60, 255 };
-            oIconColor = (SDL_Color){180,  60,  90, 255 };
+        // Reset button
+        if (mx>=resetButton.x && mx<=resetButton.x+resetButton.w &&
+            my>=resetButton.y && my<=resetButton.y+resetButton.h) {
+            scoreX = scoreO = 0;
+            firstPlayer = 1;
+            startNextRound();
+            playback_begin_new_game();
+            return;
         }
 
-        drawRoundedRectFilled(boardRect, 16, boardFillUse);
-        drawRoundedRectOutline(boardRect, 16, boardBorderUse);
+        // Any other click while the result shows: next game now
+        if (roundOver) {
+            startNextRound();
+            return;
+        }
 
+        // Board clicks
         int gx = boardRect.x + BOARD_PAD;
         int gy = boardRect.y + BOARD_PAD;
+        int stride = CELL_SIZE + GRID_GAP;
+
+        if (mx >= gx && mx <= gx + 3*CELL_SIZE + 2*GRID_GAP &&
+            my >= gy && my <= gy + 3*CELL_SIZE + 2*GRID_GAP) {
+
+            int relx = mx - gx;
+            int rely = my - gy;
+            int c = relx / stride;
+            int r = rely / stride;
+            int inCellX = relx % stride;
+            int inCellY = rely % stride;
+
+            if (c>=0 && c<3 && r>=0 && r<3 &&
+                inCellX < CELL_SIZE && inCellY < CELL_SIZE) {
+                if (board[r][c] == EMPTY) {
+                    int ply = 1;
+                    for (int i = 0; i < 9; ++i) ply += board[i/3][i%3] != EMPTY;
+                    inputlat_begin(event->button.timestamp, gameIndex, ply, r*3 + c);
+                    Cell playerPiece = (gameMode==MODE_SP)
+                        ? ((playerSide==SIDE_X) ? X : O)
+                        : ((currentPlayer==1)?X:O);
+
+                    board[r][c] = playerPiece;
+                    playback_record_move(r, c, playerPiece);//record player move
+                    anim_start(ANIM_PLACE + r*3 + c, SDL_GetTicks(), 0, PLACE_MS, EASE_OUT);
+                    currentPlayer = (currentPlayer == 1) ? 2 : 1;
+
+                    hintIndex = -1;
+                    lastHumanActivityTicks = SDL_GetTicks();
+                    needsRedraw = 1;
+                    inputlat_handled();
+                }
+            }
+        }
+    }
+}
+
+static void gameUpdate(Scene *s, Uint32 now)
+{
+    (void)s;
+    // AI move
+    if (gameMode==MODE_SP) {
+        int whoseTurnPiece = (currentPlayer==1)? X : O; // chooses which piece to move
+        // checks if board is not full before moving and no winners yet
+        if (whoseTurnPiece == aiPiece &&
+            !isBoardFull() && checkWin()==0) {
+            botMove();
+            currentPlayer = (currentPlayer == 1) ? 2 : 1;   // alternates player turn
+        }
+    }
+
+    // Game over: the result plays out while input stays live. The same
+    // timestamp for this and the animation frame below, so the banner
+    // can't finish between the two unnoticed.
+    if (!roundOver) {
+        int winner = checkWin();
+        if (winner || isBoardFull()) finishRound(winner);
+    } else if (anim_done(ANIM_BANNER_OUT, now)) {
+        startNextRound();
+    }
 
-        for (int r=0; r<3; ++r) {
-            for (int c=0; c<3; ++c) {
-                SDL_Rect cell = {
-                    gx + c*(CELL_SIZE + GRID_GAP),
-                    gy + r*(CELL_SIZE + GRID_GAP),
-                    CELL_SIZE, CELL_SIZE
-                };
-
-                drawRoundedRectFilled(cell, 12, cellFillUse);
-                drawRoundedRectOutline(cell, 12, cellBorderUse);
-
-                int inset = 18;
-                int stroke = 14;
-                if (pbBoard[r][c] == X) {
-                    drawXIcon(cell, inset, stroke, xIconColor);
-                } else if (pbBoard[r][c] == O) {
-                    drawOIcon(cell, inset, stroke, oIconColor, cellFillUse);
+    // Hint logic (prevent AI from winning)
+    if (gameMode == MODE_SP) {
+        Cell humanPiece = (playerSide == SIDE_X) ? X : O;
+        Cell whoseTurnPiece = (currentPlayer == 1) ? X : O;
+
+        if (whoseTurnPiece == humanPiece &&
+            checkWin() == 0 &&
+            !isBoardFull()) {
+
+            if (lastHumanActivityTicks != 0 &&
+                (now - lastHumanActivityTicks) > HINT_IDLE_MS) {
+                TRACE_BEGIN("find_blocking_move", "engine");
+                int idx = find_blocking_move_against_ai(board, aiPiece);
+                TRACE_END();
+                if (idx != hintIndex) {
+                    if (hintIndex != -1) markDirty(cellRect(hintIndex));
+                    if (idx != -1) markDirty(cellRect(idx));
+                    hintIndex = idx;
                 }
             }
+        } else if (hintIndex != -1) {
+            markDirty(cellRect(hintIndex));
+            hintIndex = -1;
+        }
+    }
+
+    // Blinking hint: only its cell is redrawn
+    if (hintIndex != -1) {
+        int blinkOn = ((now / HINT_BLINK_MS) % 2) == 0;
+        if (blinkOn != hintBlinkOn) markDirty(cellRect(hintIndex));
+        hintBlinkOn = blinkOn;
+    }
+
+    // Animations: redraw what each moving one covers
+    if (anim_frame(ANIM_WIN_LINE, now)) markDirty(boardRect);
+    if (anim_frame(ANIM_BANNER_IN, now) | anim_frame(ANIM_BANNER_OUT, now))
+        markDirty(bannerRect());
+    for (int i = 0; i < 9; ++i)
+        if (anim_frame(ANIM_PLACE + i, now)) markDirty(cellRect(i));
+
+    // Overlay: a couple of refreshes a second, old and new size
+    if (hudVisible) {
+        SDL_Rect old = hud_rect(HUD_X, HUD_Y);
+        if (hud_update(renderer, hudFont, now)) {
+            markDirty(old);
+            markDirty(hud_rect(HUD_X, HUD_Y));
+        }
+    }
+}
+
+static void gameDraw(Scene *s)
+{
+    (void)s;
+    drawGame();
+}
+
+static Scene gameScene = {
+    "frame", NULL, gameEvent, gameUpdate, gameDue, gameDraw,
+    NULL, NULL, 0, NULL, -1
+};
+
+// New session from the menus: scores from zero, X first
+static void startSession(void)
+{
+    while (nScenes > 1) scene_pop();        // back to the main menu underneath
+    scoreX = scoreO = 0;
+    firstPlayer = 1;
+    startNextRound();
+    playback_begin_new_game();  //NEW GAME PLAYBACK RECORD
+    lastHumanActivityTicks = SDL_GetTicks();    // check for player idle time
+    hintIndex = -1;
+    scene_push(&gameScene);
+}
+
+// The one loop: runs until the window is closed or the last scene is popped
+static void runScenes(void)
+{
+    while (nScenes > 0) {
+        Scene *s = scenes[nScenes - 1];
+        int timeout = s->due ? s->due(s, SDL_GetTicks()) : -1;
+        if (needsRedraw || dirtyRect.w)
+            timeout = 0;
+        if (timeout != 0) {
+            TRACE_BEGIN("wait", "idle");
+            SDL_WaitEventTimeout(NULL, timeout);
+            TRACE_END();
         }
 
-        // Bottom buttons: Prev / Next / Back
-        int btnW = 140, btnH = 50;
-        int gap  = 20;
-        int totalW = btnW*3 + gap*2;
-        int startX = (WINDOW_WIDTH - totalW)/2;
-        int by = WINDOW_HEIGHT - 80;
-
-        SDL_Rect prevBtn = { startX,              by, btnW, btnH };
-        SDL_Rect nextBtn = { startX + btnW + gap, by, btnW, btnH };
-        SDL_Rect backBtn = { startX + 2*(btnW+gap), by, btnW, btnH };
-
-        int mx, my; SDL_GetMouseState(&mx, &my);
-        int hPrev = (mx>=prevBtn.x && mx<=prevBtn.x+prevBtn.w &&
-                     my>=prevBtn.y && my<=prevBtn.y+prevBtn.h);
-        int hNext = (mx>=nextBtn.x && mx<=nextBtn.x+nextBtn.w &&
-                     my>=nextBtn.y && my<=nextBtn.y+nextBtn.h);
-        int hBack = (mx>=backBtn.x && mx<=backBtn.x+backBtn.w &&
-                     my>=backBtn.y && my<=backBtn.y+backBtn.h);
-
-        drawButton(prevBtn, "< Prev", hPrev, ICON_NONE);
-        drawButton(nextBtn, "Next >", hNext, ICON_NONE);
-        drawButton(backBtn, "Back",   hBack, ICON_NONE);
-
-        SDL_RenderPresent(renderer);
-
-        // Handle events
-        while (SDL_PollEvent(&event)) {
+        TRACE_BEGIN(s->name, "frame");
+        SDL_Event event;
+        TRACE_BEGIN("events", "input");
+        while (nScenes > 0 && SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
-                SDL_Quit();
-                exit(0);
+                nScenes = 0;            // shuts down program if program closes
+                break;
+            }
+            // window uncovered/moved, or the renderer lost the scene texture
+            if (event.type == SDL_WINDOWEVENT || event.type == SDL_RENDER_TARGETS_RESET)
+                needsRedraw = 1;
+            if (event.type == SDL_RENDER_DEVICE_RESET) {
+                if (sceneTex) SDL_DestroyTexture(sceneTex);
+                sceneTex = NULL;
+                textcache_clear();
+                sprite_clear();
+                hud_clear();
+                needsRedraw = 1;
             }
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int x = event.button.x;
-                int y = event.button.y;
+            // a click can push or pop: later events go to the new top
+            Scene *top = scenes[nScenes - 1];
+            top->event(top, &event);
+        }
+        TRACE_END();
 
-                if (x>=prevBtn.x && x<=prevBtn.x+prevBtn.w &&
-                    y>=prevBtn.y && y<=prevBtn.y+prevBtn.h) {
-                    if (playbackIndex > 0) playbackIndex--;
-                }
-                if (x>=nextBtn.x && x<=nextBtn.x+nextBtn.w &&
-                    y>=nextBtn.y && y<=nextBtn.y+nextBtn.h) {
-                    if (playbackIndex < maxMoves) playbackIndex++;
-                }
-                if (x>=backBtn.x && x<=backBtn.x+backBtn.w &&
-                    y>=backBtn.y && y<=backBtn.y+backBtn.h) {
-                    viewing = 0;
-                    break;
-                }
+        if (nScenes > 0) {
+            s = scenes[nScenes - 1];
+            if (s->update) s->update(s, SDL_GetTicks());
+            redrawScene(s);
+        }
+        TRACE_END();
+    }
+}
+
+// ---------- Playback scene ----------
+// Autoplay: one move every autoplayMs[speed] milliseconds
+static const Uint32 autoplayMs[] = { 2000, 1000, 500, 250, 125 };
+#define AUTOPLAY_SPEEDS ((int)(sizeof(autoplayMs) / sizeof(autoplayMs[0])))
+
+static struct {
+    int gameBack;               // 0 = most recent game, 1 = the one before, ...
+    int gameCount;
+    int maxMoves;
+    Cell board[3][3];
+    int boardDirty;             // cursor moved, board needs refreshing
+    long long posSeen, posResults[3];   // games through this position
+    int autoplay, speed;
+    Uint32 nextAutoStep;
+    int hover;                  // button under the mouse, -1 = none
+} pb;
+
+enum { PB_PREV, PB_PLAY, PB_NEXT, PB_BACK, PB_OLDER, PB_NEWER, PB_BUTTONS };
+
+// Bottom buttons Prev / Play / Next / Back; Older / Newer either side of
+// the step text
+static SDL_Rect playbackButton(int i)
+{
+    int btnW = 120, btnH = 50;
+    int gap  = 16;
+    int totalW = btnW*4 + gap*3;
+    int startX = (WINDOW_WIDTH - totalW)/2;
+    int by = WINDOW_HEIGHT - 80;
+    if (i == PB_OLDER) return (SDL_Rect){ startX,                72, 120, 40 };
+    if (i == PB_NEWER) return (SDL_Rect){ startX + totalW - 120, 72, 120, 40 };
+    return (SDL_Rect){ startX + i*(btnW + gap), by, btnW, btnH };
+}
+
+// Older/Newer are only there when there is a game to go to
+static int playbackButtonAt(int x, int y)
+{
+    for (int i = 0; i < PB_BUTTONS; ++i) {
+        if (i == PB_OLDER && pb.gameBack + 1 >= pb.gameCount) continue;
+        if (i == PB_NEWER && pb.gameBack == 0) continue;
+        SDL_Rect r = playbackButton(i);
+        if (x>=r.x && x<=r.x+r.w && y>=r.y && y<=r.y+r.h) return i;
+    }
+    return -1;
+}
+
+static void playbackEnter(Scene *s)
+{
+    (void)s;
+    pb.gameBack     = 0;
+    pb.gameCount    = playback_game_count();
+    playback_select_game(pb.gameBack);
+    pb.maxMoves     = playback_get_move_count();
+    pb.boardDirty   = 1;
+    pb.autoplay     = 0;
+    pb.speed        = 1;
+    pb.nextAutoStep = 0;
+    pb.hover        = -1;
+}
+
+static void playbackUpdate(Scene *s, Uint32 now)
+{
+    (void)s;
+    if (pb.autoplay && now >= pb.nextAutoStep) {
+        if (playback_step_forward()) {
+            pb.boardDirty   = 1;
+            pb.nextAutoStep = now + autoplayMs[pb.speed];
+        } else {
+            pb.autoplay = 0;    // reached the end
+        }
+        needsRedraw = 1;
+    }
+    // Board state only changes when the cursor moves
+    if (pb.boardDirty) {
+        playback_cursor_board(pb.board);
+        TRACE_BEGIN("posindex_lookup", "engine");
+        pb.posSeen = posindex_lookup(pb.board, pb.posResults);
+        TRACE_END();
+        pb.boardDirty = 0;
+        needsRedraw = 1;
+    }
+}
+
+// sleep until input or the next autoplay step
+static int playbackDue(Scene *s, Uint32 now)
+{
+    (void)s;
+    if (!pb.autoplay) return -1;
+    return now < pb.nextAutoStep ? (int)(pb.nextAutoStep - now) : 0;
+}
+
+static void playbackEvent(Scene *s, const SDL_Event *event)
+{
+    (void)s;
+    int wantBack = pb.gameBack;
+    int toggleAutoplay = 0;
+    if (event->type == SDL_MOUSEMOTION) {
+        int h = playbackButtonAt(event->motion.x, event->motion.y);
+        if (h != pb.hover) needsRedraw = 1;
+        pb.hover = h;
+        return;
+    }
+    needsRedraw = 1;    // anything else: clicks, keys, a verdict from the analysis thread
+    if (event->type == SDL_MOUSEBUTTONDOWN) {
+        switch (playbackButtonAt(event->button.x, event->button.y)) {
+        case PB_OLDER: wantBack = pb.gameBack + 1; break;
+        case PB_NEWER: wantBack = pb.gameBack - 1; break;
+        case PB_PREV:
+            pb.autoplay = 0;
+            if (playback_step_back()) pb.boardDirty = 1;
+            break;
+        case PB_PLAY:  toggleAutoplay = 1; break;
+        case PB_NEXT:
+            pb.autoplay = 0;
+            if (playback_step_forward()) pb.boardDirty = 1;
+            break;
+        case PB_BACK:
+            scene_pop();
+            return;
+        }
+    }
+    if (event->type == SDL_KEYDOWN) {
+        if (event->key.keysym.sym == SDLK_LEFT) {
+            pb.autoplay = 0;
+            if (playback_step_back()) pb.boardDirty = 1;
+        } else if (event->key.keysym.sym == SDLK_RIGHT) {
+            pb.autoplay = 0;
+            if (playback_step_forward()) pb.boardDirty = 1;
+        } else if (event->key.keysym.sym == SDLK_HOME) {
+            playback_seek(0);
+            pb.boardDirty = 1;
+        } else if (event->key.keysym.sym == SDLK_END) {
+            playback_seek(pb.maxMoves);
+            pb.boardDirty = 1;
+        } else if (event->key.keysym.sym == SDLK_SPACE) {
+            toggleAutoplay = 1;
+        } else if (event->key.keysym.sym == SDLK_PLUS || event->key.keysym.sym == SDLK_EQUALS ||
+                   event->key.keysym.sym == SDLK_KP_PLUS) {
+            if (pb.speed < AUTOPLAY_SPEEDS - 1) pb.speed++;   // faster
+            pb.nextAutoStep = SDL_GetTicks() + autoplayMs[pb.speed];
+        } else if (event->key.keysym.sym == SDLK_MINUS || event->key.keysym.sym == SDLK_KP_MINUS) {
+            if (pb.speed > 0) pb.speed--;                     // slower
+            pb.nextAutoStep = SDL_GetTicks() + autoplayMs[pb.speed];
+        } else if (event->key.keysym.sym == SDLK_UP) {
+            wantBack = pb.gameBack + 1;
+        } else if (event->key.keysym.sym == SDLK_DOWN) {
+            wantBack = pb.gameBack - 1;
+        } else if (event->key.keysym.sym == SDLK_PAGEUP) {
+            wantBack = pb.gameBack + 10;
+        } else if (event->key.keysym.sym == SDLK_PAGEDOWN) {
+            wantBack = pb.gameBack - 10;
+        } else if (event->key.keysym.sym == SDLK_ESCAPE) {
+            scene_pop();
+            return;
+        }
+    }
+    if (toggleAutoplay) {
+        pb.autoplay = !pb.autoplay;
+        if (pb.autoplay && playback_cursor_step() >= pb.maxMoves) {
+            playback_seek(0);               // replay from the start
+            pb.boardDirty = 1;
+        }
+        pb.nextAutoStep = SDL_GetTicks() + autoplayMs[pb.speed];
+    }
+    // switch to another game from the history
+    if (wantBack >= pb.gameCount) wantBack = pb.gameCount - 1;
+    if (wantBack < 0) wantBack = 0;
+    if (wantBack != pb.gameBack && playback_select_game(wantBack)) {
+        pb.gameBack   = wantBack;
+        pb.maxMoves   = playback_get_move_count();
+        pb.boardDirty = 1;   // selecting a game rewinds the cursor
+    }
+}
+
+// playback screen rendering
+static void playbackDraw(Scene *s)
+{
+    (void)s;
+    // Background based on current theme
+    setColor(getBackgroundColor());
+    SDL_RenderFillRect(renderer, NULL);
+
+    // Title
+    char titleBuf[96];
+    if (pb.gameBack == 0)
+        snprintf(titleBuf, sizeof(titleBuf), "Playback - Last Game (#%d)", playback_selected_game_id());
+    else
+        snprintf(titleBuf, sizeof(titleBuf), "Playback - Game #%d of %d",
+                 playback_selected_game_id(), pb.gameCount);
+    SDL_Texture* title = getTextTexture(titleBuf, font, getTextColor());
+    if (title) {
+        int tw, th;
+        SDL_QueryTexture(title, NULL, NULL, &tw, &th);
+        SDL_Rect tpos = { (WINDOW_WIDTH - tw)/2, 40, tw, th };
+        SDL_RenderCopy(renderer, title, NULL, &tpos);
+    }
+
+    // Step text: "Move X / N" (+ autoplay speed)
+    char stepBuf[64];
+    if (pb.autoplay)
+        snprintf(stepBuf, sizeof(stepBuf), "Move %d / %d  (%.2gs)",
+                 playback_cursor_step(), pb.maxMoves, autoplayMs[pb.speed] / 1000.0);
+    else
+        snprintf(stepBuf, sizeof(stepBuf), "Move %d / %d", playback_cursor_step(), pb.maxMoves);
+    SDL_Texture* stepTex = getTextTexture(stepBuf, font, getTextColor());
+    if (stepTex) {
+        int sw, sh;
+        SDL_QueryTexture(stepTex, NULL, NULL, &sw, &sh);
+        SDL_Rect spos = { (WINDOW_WIDTH - sw)/2, 80, sw, sh };
+        SDL_RenderCopy(renderer, stepTex, NULL, &spos);
+    }
+
+    // Board layout (same maths as drawGame, centred)
+    SDL_Rect pbRect;
+    int cardSide = 3*CELL_SIZE + 2*GRID_GAP + 2*BOARD_PAD;
+    pbRect.w = cardSide;
+    pbRect.h = cardSide;
+    pbRect.x = (WINDOW_WIDTH - pbRect.w)/2;
+    pbRect.y = WINDOW_HEIGHT/2 - pbRect.h/2;
+    SDL_Color boardFillUse   = boardFill;
+    SDL_Color boardBorderUse = boardBorder;
+    SDL_Color cellFillUse    = cellFill;
+    SDL_Color cellBorderUse  = cellBorder;
+
+    SDL_Color xIconColor = xColor;
+    SDL_Color oIconColor = oColor;
+
+    if (currentTheme == THEME_FUN) {
+        boardFillUse   = funBoardFill;
+        cellFillUse    = funCellFill;
+        SDL_Color black = (SDL_Color){0,0,0,255};
+        boardBorderUse = black;
+        cellBorderUse  = black;
+
+        xIconColor = (SDL_Color){ 20, 150,  60, 255 };
+        oIconColor = (SDL_Color){180,  60,  90, 255 };
+    }
+
+    drawRoundedCard(pbRect, 16, boardFillUse, &boardBorderUse);
+
+    int gx = pbRect.x + BOARD_PAD;
+    int gy = pbRect.y + BOARD_PAD;
+
+    for (int r=0; r<3; ++r) {
+        for (int c=0; c<3; ++c) {
+            SDL_Rect cell = {
+                gx + c*(CELL_SIZE + GRID_GAP),
+                gy + r*(CELL_SIZE + GRID_GAP),
+                CELL_SIZE, CELL_SIZE
+            };
+
+            drawRoundedCard(cell, 12, cellFillUse, &cellBorderUse);
+
+            int inset = 18;
+            int stroke = 14;
+            if (pb.board[r][c] == X) {
+                drawXIcon(cell, inset, stroke, xIconColor, 1.0f);
+            } else if (pb.board[r][c] == O) {
+                drawOIcon(cell, inset, stroke, oIconColor, 1.0f);
             }
-            if (event.type == SDL_KEYDOWN) {
-                if (event.key.keysym.sym == SDLK_LEFT) {
-                    if (playbackIndex > 0) playbackIndex--;
-                } else if (event.key.keysym.sym == SDLK_RIGHT) {
-                    if (playbackIndex < maxMoves) playbackIndex++;
-                } else if (event.key.keysym.sym == SDLK_ESCAPE) {
-                    viewing = 0;
-                    break;
-                }
+        }
+    }
+
+    // Perfect-play verdict for this step (filled in by the analysis thread)
+    char noteBuf[96];
+    int verdict = analysis_annotation((unsigned)playback_selected_game_id(),
+                                      playback_cursor_step(), noteBuf, sizeof(noteBuf));
+    if (verdict < 0) snprintf(noteBuf, sizeof(noteBuf), "Analysing...");
+    SDL_Color noteColor = (verdict == 2) ? (SDL_Color){220,  60,  60, 255}
+                        : (verdict == 1) ? (SDL_Color){230, 150,  40, 255}
+                        : getTextColor();
+    SDL_Texture* noteTex = getTextTexture(noteBuf, font, noteColor);
+    if (noteTex) {
+        int nw, nh;
+        SDL_QueryTexture(noteTex, NULL, NULL, &nw, &nh);
+        SDL_Rect npos = { (WINDOW_WIDTH - nw)/2, 128, nw, nh };
+        SDL_RenderCopy(renderer, noteTex, NULL, &npos);
+    }
+
+    // How other recorded games went from this position
+    if (playback_cursor_step() > 0 && pb.posSeen > 0) {
+        char seenBuf[96];
+        snprintf(seenBuf, sizeof(seenBuf), "Seen in %lld games: X %lld / O %lld / Draw %lld",
+                 pb.posSeen, pb.posResults[1], pb.posResults[2], pb.posResults[0]);
+        SDL_Texture* seenTex = getTextTexture(seenBuf, font, getTextColor());
+        if (seenTex) {
+            int sw, sh;
+            SDL_QueryTexture(seenTex, NULL, NULL, &sw, &sh);
+            SDL_Rect spos = { (WINDOW_WIDTH - sw)/2, pbRect.y + pbRect.h + 16, sw, sh };
+            SDL_RenderCopy(renderer, seenTex, NULL, &spos);
+        }
+    }
+
+
+    // Bottom buttons, and the game browsing buttons either side of the step text
+    static const char *const labels[PB_BUTTONS] = { "< Prev", "Play", "Next >", "Back", "Older", "Newer" };
+    int mx, my; SDL_GetMouseState(&mx, &my);
+    pb.hover = playbackButtonAt(mx, my);
+    for (int i = 0; i < PB_BUTTONS; ++i) {
+        if (i == PB_OLDER && pb.gameBack + 1 >= pb.gameCount) continue;
+        if (i == PB_NEWER && pb.gameBack == 0) continue;
+        const char *label = (i == PB_PLAY && pb.autoplay) ? "Pause" : labels[i];
+        drawButton(playbackButton(i), label, pb.hover == i, ICON_NONE);
+    }
+}
+
+static Scene playbackScene = {
+    "playbackScreen", playbackEnter, playbackEvent, playbackUpdate, playbackDue, playbackDraw,
+    NULL, NULL, 0, NULL, -1
+};
+
+// ---------- Sprite atlas benchmark ----------
+// Renders the game screen and the main menu buttons offscreen (software
+// renderer) with every shape drawn directly, then from the sprite atlas,
+// and compares draw calls, time per frame and the resulting pixels.
+static void benchMenuFrame(void)
+{
+    drawMenu(&mainMenuScene);
+    SDL_RenderPresent(renderer);
+}
+
+static int spriteBench(int frames)
+{
+    static const char *const screenNames[2] = { "game", "menu" };
+    static const char *const modeNames[2] = { "direct", "atlas" };
+    size_t bytes = (size_t)WINDOW_WIDTH * WINDOW_HEIGHT * 4;
+    Uint32 *pixels[2][2] = { { NULL, NULL }, { NULL, NULL } };
+    int rc = 0;
+
+    if (TTF_Init() == 0) font = TTF_OpenFont("arial.ttf", 28);
+    if (!font) printf("(arial.ttf not found: text is not drawn)\n");
+    initBoard();
+    board[1][1] = X; board[0][0] = O; board[2][2] = X; board[0][2] = O; board[2][0] = X;
+    gameMode = MODE_SP; aiDiff = DIFF_HARD; playerSide = SIDE_X; hintIndex = -1;
+
+    printf("%-6s %-7s %12s %10s\n", "screen", "shapes", "draws/frame", "ms/frame");
+    for (int mode = 0; mode < 2 && rc == 0; ++mode) {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+        renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+        if (!renderer) {
+            fprintf(stderr, "software renderer: %s\n", SDL_GetError());
+            if (surface) SDL_FreeSurface(surface);
+            rc = 1;
+            break;
+        }
+        useSprites = mode;
+        for (int screen = 0; screen < 2; ++screen) {
+            if (screen == 0) renderGame(); else benchMenuFrame();   // warm the caches
+            drawCalls = 0;
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            for (int f = 0; f < frames; ++f) {
+                if (screen == 0) renderGame(); else benchMenuFrame();
             }
+            double ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0
+                        / (double)SDL_GetPerformanceFrequency() / frames;
+            printf("%-6s %-7s %12lu %10.3f\n", screenNames[screen], modeNames[mode],
+                   drawCalls / (unsigned long)frames, ms);
+            pixels[screen][mode] = malloc(bytes);
+            if (pixels[screen][mode])
+                for (int y = 0; y < WINDOW_HEIGHT; ++y)
+                    memcpy((char *)pixels[screen][mode] + (size_t)y * WINDOW_WIDTH * 4,
+                           (char *)surface->pixels + (size_t)y * surface->pitch, (size_t)WINDOW_WIDTH * 4);
         }
+        textcache_clear();     // both belong to this renderer
+        sprite_clear();
+        SDL_DestroyRenderer(renderer);
+        renderer = NULL;
+        SDL_FreeSurface(surface);
+    }
+    // Antialiased edges need not match exactly: blending into the atlas and
+    // then onto the screen rounds differently, and the software renderer
+    // snaps vertices to whole pixels, so directly drawn edges shift by half
+    // a pixel where an atlas slot would clip them.
+    for (int screen = 0; screen < 2 && rc == 0; ++screen) {
+        long long differ = 0;
+        int maxDiff = 0;
+        if (!pixels[screen][0] || !pixels[screen][1]) continue;
+        for (size_t i = 0; i < bytes / 4; ++i) {
+            Uint32 p = pixels[screen][0][i], q = pixels[screen][1][i];
+            int d = 0;
+            for (int shift = 0; shift < 24; shift += 8) {      // RGB; alpha isn't shown
+                int c = abs((int)((p >> shift) & 0xFF) - (int)((q >> shift) & 0xFF));
+                if (c > d) d = c;
+            }
+            differ += d != 0;
+            if (d > maxDiff) maxDiff = d;
+        }
+        if (differ)
+            printf("%s screen: %lld of %d pixels differ (by up to %d)\n", screenNames[screen],
+                   differ, WINDOW_WIDTH * WINDOW_HEIGHT, maxDiff);
+        else
+            printf("%s screen: identical pixels with and without the atlas\n", screenNames[screen]);
+    }
+    for (int i = 0; i < 4; ++i) free(pixels[i / 2][i % 2]);
+    if (font) TTF_CloseFont(font);
+    font = NULL;
+    TTF_Quit();
+    return rc;
+}
+
+// ---------- Headless render benchmark ----------
+// Runs each screen through the real frame path (redrawScene: scene
+// texture, copy, present) on the software renderer into an offscreen
+// surface, so no display or vsync is involved. Every frame is a full
+// redraw. The final frame of each screen can be saved as a reference BMP
+// or compared against one.
+static const int benchMoves[7][2] = {       // X wins on the bottom row
+    {1,1}, {0,0}, {2,2}, {0,2}, {2,0}, {1,0}, {2,1}
+};
+
+static void benchPlay(int n)
+{
+    startNextRound();
+    playback_begin_new_game();
+    for (int i = 0; i < n; ++i) {
+        Cell piece = (i % 2 == 0) ? X : O;
+        board[benchMoves[i][0]][benchMoves[i][1]] = piece;
+        playback_record_move(benchMoves[i][0], benchMoves[i][1], piece);
+    }
+    currentPlayer = (n % 2 == 0) ? 1 : 2;
+}
+
+static void benchGameEmpty(void) { benchPlay(0); }
+static void benchGameMid(void)   { benchPlay(5); }
+
+// The finished game, win line and banner fully in. It also becomes the
+// game the playback screen shows (bulk mode: history only, no files).
+static void benchGameOver(void)
+{
+    benchPlay(7);
+    finishRound(X);
+    Uint32 past = SDL_GetTicks() - 10000;
+    anim_start(ANIM_WIN_LINE,  past, 0, WINLINE_MS, EASE_OUT);
+    anim_start(ANIM_BANNER_IN, past, 0, BANNER_FADE_MS, EASE_OUT);
+    anim_stop(ANIM_BANNER_OUT);
+}
+
+// Waits (up to 5 s) for the analysis worker, so every run draws the
+// verdict rather than "Analysing..." some of the time.
+static void benchPlayback(void)
+{
+    char note[96];
+    playback_seek(5);
+    pb.boardDirty = 1;
+    playbackUpdate(&playbackScene, SDL_GetTicks());
+    for (int i = 0; i < 5000 && analysis_annotation((unsigned)playback_selected_game_id(),
+                                                    playback_cursor_step(), note, sizeof note) < 0; ++i)
+        SDL_Delay(1);
+    SDL_FlushEvent(SDL_USEREVENT);          // the worker's wake-up
+}
+
+static int cmpDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// nearest rank, v sorted
+static double benchPercentile(const double *v, int n, double pct)
+{
+    int i = (int)ceil(pct / 100.0 * n) - 1;
+    return v[i < 0 ? 0 : (i >= n ? n - 1 : i)];
+}
+
+// Compares the frame in 'surface' with <dir>/<name>.bmp. Returns 1 if they match.
+static int benchCheck(SDL_Surface *surface, const char *dir, const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof path, "%s/%s.bmp", dir, name);
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    SDL_Surface *ref = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+    if (loaded) SDL_FreeSurface(loaded);
+    if (!ref || ref->w != surface->w || ref->h != surface->h) {
+        printf("  %s: no usable reference frame %s\n", name, path);
+        if (ref) SDL_FreeSurface(ref);
+        return 0;
+    }
+    long long differ = 0;
+    int maxDiff = 0;
+    for (int y = 0; y < ref->h; ++y) {
+        const Uint32 *p = (const Uint32 *)((const char *)surface->pixels + (size_t)y * surface->pitch);
+        const Uint32 *q = (const Uint32 *)((const char *)ref->pixels + (size_t)y * ref->pitch);
+        for (int x = 0; x < ref->w; ++x) {
+            int d = 0;
+            for (int shift = 0; shift < 24; shift += 8) {      // RGB; alpha isn't shown
+                int c = abs((int)((p[x] >> shift) & 0xFF) - (int)((q[x] >> shift) & 0xFF));
+                if (c > d) d = c;
+            }
+            differ += d != 0;
+            if (d > maxDiff) maxDiff = d;
+        }
+    }
+    SDL_FreeSurface(ref);
+    if (differ)
+        printf("  %s: %lld pixels differ from %s (by up to %d)\n", name, differ, path, maxDiff);
+    return differ == 0;
+}
+
+static int renderBench(int frames, const char *dumpDir, const char *checkDir)
+{
+    static const struct {
+        const char *name;
+        Scene *scene;
+        void (*setup)(void);                // after the scene is pushed
+    } benchScenes[] = {
+        { "menu",       &mainMenuScene,   NULL },
+        { "theme",      &themeScene,      NULL },
+        { "difficulty", &difficultyScene, NULL },
+        { "side",       &sideScene,       NULL },
+        { "game-empty", &gameScene,       benchGameEmpty },
+        { "game-mid",   &gameScene,       benchGameMid },
+        { "game-over",  &gameScene,       benchGameOver },
+        { "playback",   &playbackScene,   benchPlayback },
+    };
+    const int nBench = (int)(sizeof benchScenes / sizeof benchScenes[0]);
+    int rc = 0, mismatches = 0;
+
+    double *ms = malloc(sizeof *ms * (size_t)frames);
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!ms || !renderer) {
+        fprintf(stderr, "software renderer: %s\n", SDL_GetError());
+        free(ms);
+        if (surface) SDL_FreeSurface(surface);
+        return 1;
+    }
+    if (TTF_Init() == 0) font = TTF_OpenFont("arial.ttf", 28);
+    if (!font) printf("(arial.ttf not found: text is not drawn)\n");
+
+    playback_set_bulk(1, 0);                // scripted games stay in memory
+    currentTheme = THEME_DARK;
+    gameMode = MODE_SP; aiDiff = DIFF_HARD; playerSide = SIDE_X; aiPiece = O;
+    hintIndex = -1;
+
+    printf("%d frames per screen, software renderer %dx%d\n", frames, WINDOW_WIDTH, WINDOW_HEIGHT);
+    printf("%-11s %9s %9s %8s %8s %8s %8s %12s\n",
+           "screen", "frames/s", "first ms", "p50", "p90", "p99", "max", "draws/frame");
+    for (int b = 0; b < nBench; ++b) {
+        Scene *s = benchScenes[b].scene;
+        nScenes = 0;
+        scene_push(s);
+        if (benchScenes[b].setup) benchScenes[b].setup();
+
+        Uint64 freq = SDL_GetPerformanceFrequency();
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        needsRedraw = 1;
+        redrawScene(s);                     // cold: text textures, atlas slots
+        double first = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)freq;
+
+        drawCalls = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int f = 0; f < frames; ++f) {
+            Uint64 f0 = SDL_GetPerformanceCounter();
+            needsRedraw = 1;
+            redrawScene(s);
+            ms[f] = (double)(SDL_GetPerformanceCounter() - f0) * 1000.0 / (double)freq;
+        }
+        double total = (double)(SDL_GetPerformanceCounter() - start) / (double)freq;
+        qsort(ms, (size_t)frames, sizeof *ms, cmpDouble);
+        printf("%-11s %9.0f %9.3f %8.3f %8.3f %8.3f %8.3f %12lu\n", benchScenes[b].name,
+               total > 0 ? frames / total : 0.0, first,
+               benchPercentile(ms, frames, 50), benchPercentile(ms, frames, 90),
+               benchPercentile(ms, frames, 99), ms[frames - 1],
+               drawCalls / (unsigned long)frames);
+
+        if (dumpDir) {
+            char path[512];
+            snprintf(path, sizeof path, "%s/%s.bmp", dumpDir, benchScenes[b].name);
+            if (SDL_SaveBMP(surface, path) != 0) {
+                fprintf(stderr, "can't write %s: %s\n", path, SDL_GetError());
+                rc = 1;
+            }
+        }
+        if (checkDir && !benchCheck(surface, checkDir, benchScenes[b].name))
+            mismatches++;
+    }
+    if (checkDir) {
+        if (mismatches) printf("%d of %d screens differ from the reference frames\n", mismatches, nBench);
+        else            printf("all %d screens match the reference frames\n", nBench);
+        if (mismatches) rc = 1;
+    }
+
+    nScenes = 0;
+    anim_stop_all();
+    playback_shutdown();                    // joins the analysis worker
+    playback_set_bulk(0, 0);
+    if (sceneTex) SDL_DestroyTexture(sceneTex);
+    sceneTex = NULL;
+    textcache_clear();                      // all belong to this renderer
+    sprite_clear();
+    SDL_DestroyRenderer(renderer);
+    renderer = NULL;
+    SDL_FreeSurface(surface);
+    free(ms);
+    if (font) TTF_CloseFont(font);
+    font = NULL;
+    TTF_Quit();
+    return rc;
+}
+
+// ---------- Command-line tools (run without opening a window) ----------
+// Returns the exit code of the tool, or -1 if argv asks for no tool.
+static int runTool(int argc, char *argv[])
+{
+    if (argc < 2) return -1;
+
+    // ttt.exe --nb-stats <dataset> [k] [threads] [seed]
+    if (strcmp(argv[1], "--nb-stats") == 0) {
+        if (argc < 3) {
+            fprintf(stderr, "usage: %s --nb-stats <dataset> [k] [threads] [seed]\n", argv[0]);
+            return 1;
+        }
+        int k       = (argc > 3) ? atoi(argv[3]) : 5;
+        int threads = (argc > 4) ? atoi(argv[4]) : 0;
+        unsigned long long seed = (argc > 5) ? strtoull(argv[5], NULL, 10) : 1103ull;
+        nb_kfold_cross_validate(argv[2], k, seed, threads);
+        return 0;
+    }
+
+    // ttt.exe --nb-dedup [--canonical] [--augment] [--k K] [--threads N] [--seed S]
+    //                   [--model <model-out>] <data files...>
+    if (strcmp(argv[1], "--nb-dedup") == 0) {
+        int canonical = 0, augment = 0, k = 5, threads = 0;
+        unsigned long long seed = 1103ull;
+        const char *modelOut = NULL;
+        const char **files = malloc(sizeof(char *) * (size_t)argc);
+        int nFiles = 0;
+        if (!files) return 1;
+        for (int i = 2; i < argc; i++) {
+            if      (strcmp(argv[i], "--canonical") == 0) canonical = 1;
+            else if (strcmp(argv[i], "--augment") == 0)   augment = 1;
+            else if (strcmp(argv[i], "--k") == 0 && i + 1 < argc)       k = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)    seed = strtoull(argv[++i], NULL, 10);
+            else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)   modelOut = argv[++i];
+            else files[nFiles++] = argv[i];
+        }
+        if (nFiles == 0) {
+            fprintf(stderr, "usage: %s --nb-dedup [--canonical] [--augment] [--k K] [--threads N]"
+                            " [--seed S] [--model <model-out>] <data files...>\n", argv[0]);
+            free(files);
+            return 1;
+        }
+        int rc = 0;
+        nb_dedup_report(files, nFiles, threads, canonical, augment, k, seed);
+        if (modelOut) {
+            if (nb_train_dedup(files, nFiles, threads, canonical, augment) < 0 ||
+                !nb_save_snapshot(modelOut)) {
+                fprintf(stderr, "[NB] Training failed.\n");
+                rc = 1;
+            } else {
+                printf("Model saved to '%s'\n", modelOut);
+            }
+        }
+        free(files);
+        return rc;
+    }
 
-        SDL_Delay(16);
+    // ttt.exe --selfplay <out> [options], see selfplay.c
+    if (strcmp(argv[1], "--selfplay") == 0)
+        return selfplay_main(argc, argv);
+
+    // ttt.exe --sprite-bench [frames]
+    if (strcmp(argv[1], "--sprite-bench") == 0) {
+        int frames = (argc > 2) ? atoi(argv[2]) : 200;
+        return spriteBench(frames > 0 ? frames : 200);
     }
+
+    // ttt.exe --render-bench [frames] [--dump <dir>] [--check <dir>]
+    if (strcmp(argv[1], "--render-bench") == 0) {
+        int frames = 300;
+        const char *dumpDir = NULL, *checkDir = NULL;
+        for (int i = 2; i < argc; i++) {
+            if      (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)  dumpDir = argv[++i];
+            else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) checkDir = argv[++i];
+            else frames = atoi(argv[i]);
+        }
+        return renderBench(frames > 0 ? frames : 300, dumpDir, checkDir);
+    }
+
+    // ttt.exe --latency-report [--out <prefix>] [csv files...], see latency.c
+    if (strcmp(argv[1], "--latency-report") == 0)
+        return latency_main(argc, argv);
+
+    // ttt.exe --gamedb-build / --gamedb-query [options], see gamedb.c
+    if (strcmp(argv[1], "--gamedb-build") == 0 || strcmp(argv[1], "--gamedb-query") == 0)
+        return gamedb_main(argc, argv);
+
+    // ttt.exe --posindex-build / --posindex-query <board>, see posindex.c
+    if (strcmp(argv[1], "--posindex-build") == 0 || strcmp(argv[1], "--posindex-query") == 0)
+        return posindex_main(argc, argv);
+
+    // ttt.exe --export-games <out> / --import-games <in>, see notation.c
+    if (strcmp(argv[1], "--export-games") == 0 || strcmp(argv[1], "--import-games") == 0)
+        return notation_main(argc, argv);
+
+    // ttt.exe --nb-train <model-out> [--threads N] <data files...>
+    // ttt.exe --nb-train-bench [--threads N] <data files...>
+    if (strcmp(argv[1], "--nb-train") == 0 || strcmp(argv[1], "--nb-train-bench") == 0) {
+        int bench = (strcmp(argv[1], "--nb-train-bench") == 0);
+        int first = bench ? 2 : 3;
+        int threads = 0;
+        const char **files = malloc(sizeof(char *) * (size_t)argc);
+        int nFiles = 0;
+        if (!files) return 1;
+        for (int i = first; i < argc; i++) {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+            else files[nFiles++] = argv[i];
+        }
+        if (nFiles == 0 || (!bench && argc < 4)) {
+            fprintf(stderr, "usage: %s --nb-train <model-out> [--threads N] <data files...>\n"
+                            "       %s --nb-train-bench [--threads N] <data files...>\n",
+                    argv[0], argv[0]);
+            free(files);
+            return 1;
+        }
+
+        int rc = 0;
+        if (bench) {
+            nb_train_scaling_report(files, nFiles, threads);
+        } else {
+            Uint64 t0 = SDL_GetPerformanceCounter();
+            long long rows = nb_train_sharded(files, nFiles, threads);
+            double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+            if (rows < 0 || !nb_save_snapshot(argv[2])) {
+                fprintf(stderr, "[NB] Training failed.\n");
+                rc = 1;
+            } else {
+                printf("Trained on %lld rows in %.2f s (%.0f rows/s), model saved to '%s'\n",
+                       rows, secs, secs > 0 ? rows / secs : 0.0, argv[2]);
+            }
+        }
+        free(files);
+        return rc;
+    }
+    return -1;
 }
 
 // ===================== MAIN =====================
 int main(int argc, char *argv[]) {
+    int toolResult = runTool(argc, argv);
+    if (toolResult >= 0) return toolResult;
+
+    // profiling: TTT_TRACE=<file> or --trace [file] writes a Chrome trace at exit
+    const char *tracePath = getenv("TTT_TRACE");
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--trace") == 0)
+            tracePath = (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) ? argv[i + 1] : "ttt_trace.json";
+    if (tracePath && *tracePath) trace_init(tracePath);
+
     srand((unsigned)time(NULL));
     //function to initalize logging data, game number, bot_metrics.csv
     init_metrics_logging();
@@ -1333,6 +2352,7 @@ int main(int argc, char *argv[]) {
 
     for (int i = 0; i < 3 && !font; ++i) {  // loads 3 font paths
         font = TTF_OpenFont(fontPaths[i], 28);
+        if (font) hudFont = TTF_OpenFont(fontPaths[i], 15);
     }
     if (!font) {
         fprintf(stderr, "Could not open font arial.ttf: %s\n", TTF_GetError());
@@ -1343,212 +2363,28 @@ int main(int argc, char *argv[]) {
     TTF_SetFontHinting(font, TTF_HINTING_LIGHT);
     TTF_SetFontKerning(font, 1);
 
-    // train Naive Bayes AI
-    nb_train_from_file("tic-tac-toe.data");
-
-    // menu setup
-    int modeSel = modeMenu(); // displays menu
-    if (modeSel==0) goto cleanup;   // clears the page if "Exit" is pressed
-    gameMode = (modeSel==MODE_SP)? MODE_SP: MODE_MP;    // sets gamemode based on user pref
-
-    if (gameMode==MODE_SP) {
-        for (;;) {
-            Difficulty d = difficultyMenu(); // display the difficulty menu
-            if (d != DIFF_BACK) { aiDiff = d; break; } // go back to menu if "Back" is clicked
-            modeSel = modeMenu();
-            if (modeSel==0) goto cleanup;
-            gameMode = (modeSel==MODE_SP)? MODE_SP: MODE_MP;
-            if (gameMode != MODE_SP) break; // exit back to menu if "singleplayer" is not clicked
-        }
-        if (gameMode==MODE_SP) {
-            playerSide = sideMenu();    // option to choose which side to play us
-            aiPiece = (playerSide==SIDE_X) ? O : X; // assign icon to player based on pref
-        }
-    }
-
-    lastHumanActivityTicks = SDL_GetTicks();    // cjeck for player idle time
-
-    int running = 1;
-    initBoard();    // draw the board
-    playback_begin_new_game();//NEW GAME PLAYBACK RECORD
-    currentPlayer = firstPlayer;    // stores currentplayer so loser will start first
-
-    // Main game loop
-    while (running) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) 
-            running=0;  // shuts down program if program closes
-
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int mx = event.button.x, my = event.button.y;   // click behavaiour for mouse
-
-                // Back button
-                if (mx >= backButton.x && mx <= backButton.x + backButton.w &&
-                    my >= backButton.y && my <= backButton.y + backButton.h) {
-
-                    int newMode = modeMenu();
-                    if (newMode==0) { 
-                        running=0; 
-                        break; 
-                    }
-                    gameMode = (newMode==MODE_SP)? MODE_SP: MODE_MP;
-
-                    if (gameMode==MODE_SP) {
-                        for (;;) {
-                            Difficulty d = difficultyMenu();
-                            if (d != DIFF_BACK) { aiDiff = d; break; }
-                            int tmpMode = modeMenu();
-                            if (tmpMode==0) { running=0; break; }
-                            gameMode = (tmpMode==MODE_SP)? MODE_SP: MODE_MP;
-                            if (gameMode != MODE_SP) break;
-                        }
-                        if (!running) break;
-                        if (gameMode==MODE_SP) {
-                            playerSide = sideMenu();
-                            aiPiece = (playerSide==SIDE_X) ? O : X;
-                        }
-                    }
-
-                    // resets game state
-                    scoreX=scoreO=0;
-                    initBoard();
-                    playback_begin_new_game();
-                    firstPlayer=1;
-                    currentPlayer=firstPlayer;
-                    needsRedraw=1;
-                    continue;
-                }
-
-                // Reset button
-                if (mx>=resetButton.x && mx<=resetButton.x+resetButton.w &&
-                    my>=resetButton.y && my<=resetButton.y+resetButton.h) {
-                    scoreX = scoreO = 0;
-                    initBoard();
-                    playback_begin_new_game();
-                    firstPlayer = 1;
-                    currentPlayer = firstPlayer;
-                    needsRedraw = 1;
-                    continue;
-                }
-
-                // Board clicks
-                int gx = boardRect.x + BOARD_PAD;
-                int gy = boardRect.y + BOARD_PAD;
-                int stride = CELL_SIZE + GRID_GAP;
-
-                if (mx >= gx && mx <= gx + 3*CELL_SIZE + 2*GRID_GAP &&
-                    my >= gy && my <= gy + 3*CELL_SIZE + 2*GRID_GAP) {
-
-                    int relx = mx - gx;
-                    int rely = my - gy;
-                    int c = relx / stride;
-                    int r = rely / stride;
-                    int inCellX = relx % stride;
-                    int inCellY = rely % stride;
-
-                    if (c>=0 && c<3 && r>=0 && r<3 &&
-                        inCellX < CELL_SIZE && inCellY < CELL_SIZE) {
-                        if (board[r][c] == EMPTY) {
-                            Cell playerPiece = (gameMode==MODE_SP)
-                                ? ((playerSide==SIDE_X) ? X : O)
-                                : ((currentPlayer==1)?X:O);
-
-                            board[r][c] = playerPiece;
-                            playback_record_move(r, c, playerPiece);//record player move
-                            currentPlayer = (currentPlayer == 1) ? 2 : 1;
-
-                            hintIndex = -1;
-                            lastHumanActivityTicks = SDL_GetTicks();
-                            needsRedraw = 1;
-                        }
-                    }
-                }
-            }
-        }
-
-        // AI move
-        if (gameMode==MODE_SP) {
-            int whoseTurnPiece = (currentPlayer==1)? X : O; // chooses which piece to move
-            // checks if board is not full before moving and no winners yet
-            if (whoseTurnPiece == aiPiece &&
-                !isBoardFull() && checkWin()==0) {
-                botMove();
-                currentPlayer = (currentPlayer == 1) ? 2 : 1;   // alternates player turn
-            }
-        }
-
-        // Hint logic (prevent AI from winning)
-        if (gameMode == MODE_SP) {
-            Cell humanPiece = (playerSide == SIDE_X) ? X : O;
-            Cell whoseTurnPiece = (currentPlayer == 1) ? X : O;
-
-            if (whoseTurnPiece == humanPiece &&
-                checkWin() == 0 &&
-                !isBoardFull()) {
-
-                Uint32 now = SDL_GetTicks();
-                if (lastHumanActivityTicks != 0 &&
-                    (now - lastHumanActivityTicks) > 5000) {
-                    int idx = find_blocking_move_against_ai(board, aiPiece);
-                    if (idx != hintIndex) {
-                        hintIndex = idx;
-                        needsRedraw = 1;
-                    }
-                }
-            } else {
-                hintIndex = -1;
-            }
-        }
-
-        // Keep redrawing while hint is active to allow blinking
-        if (hintIndex != -1)
-            needsRedraw = 1;
-
-        if (needsRedraw)
-            renderGame();
-
-        SDL_Delay(16);
-
-        int winner = checkWin();
-        if (winner || isBoardFull()) {
-            playback_finalize_game(); 
-            if (winner) {   // display winner message
-                SDL_Color lineColor = (currentTheme == THEME_FUN)
-                                      ? (SDL_Color){0,0,0,255}
-                                      : getTextColor();
-                animateWinLine(boardRect, lineColor);
-            }
-
-            updateScores(winner);
-
-            if (winner == X)
-                displayMessage(gameMode == MODE_SP
-                               ? ((playerSide == SIDE_X) ? "You Win!" : "CPU (X) Wins!")
-                               : "Player X Wins!");
-            else if (winner == O)
-                displayMessage(gameMode == MODE_SP
-                               ? ((playerSide == SIDE_O) ? "You Win!" : "CPU (O) Wins!")
-                               : "Player O Wins!");
-            else
-                displayMessage("Draw!");
-
-            // ensures loser will start first in the next game
-            if (winner == X) firstPlayer = 2;
-            else if (winner == O) firstPlayer = 1;
-
-            // redraws the board after winner is decided
-            currentPlayer = firstPlayer;
-            initBoard();
-            needsRedraw = 1;
-            // reset game index and move when game ends
-            gameIndex++;
-            moveIndex = 0;
-        }
-    }
-
-cleanup:    // clears and destroy all SDL states before closing the program
+    // train Naive Bayes AI (resume the online-learned model if there is one)
+    if (!nb_load_snapshot("nb_model.dat"))
+        nb_train_from_file("tic-tac-toe.data");
+
+    // game history (games.log)
+    playback_init();
+
+    // menus, game and playback all run in one loop
+    scene_push(&mainMenuScene);
+    runScenes();
+
+    // clears and destroy all SDL states before closing the program
+    nb_flush_snapshot();
+    playback_shutdown();
+    metrics_log_close();
+    trace_shutdown();
+    if (sceneTex) SDL_DestroyTexture(sceneTex);
+    textcache_clear();
+    sprite_clear();
+    hud_clear();
     if (font) TTF_CloseFont(font);
+    if (hudFont) TTF_CloseFont(hudFont);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
     TTF_Quit();
@@ -0,0 +1,76 @@
+// mapfile.c — read-only memory-mapped files (Win32 and POSIX)
+// Large logs are opened by mapping them instead of reading them, so
+// opening costs the same for ten games or ten million.
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct MappedFile {
+    const unsigned char *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+// Maps the whole file read-only. Returns NULL if it is missing, empty
+// or can't be mapped. Other handles may keep appending to the file;
+// the view just doesn't see past its original size.
+MappedFile *mapfile_open(const char *path)
+{
+    MappedFile *m = calloc(1, sizeof *m);
+    if (!m) return NULL;
+#ifdef _WIN32
+    m->file = CreateFileA(path, GENERIC_READ,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) { free(m); return NULL; }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m->file, &size) || size.QuadPart == 0) {
+        CloseHandle(m->file); free(m); return NULL;
+    }
+    m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m->mapping) { CloseHandle(m->file); free(m); return NULL; }
+    m->data = MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m->data) {
+        CloseHandle(m->mapping); CloseHandle(m->file); free(m); return NULL;
+    }
+    m->size = (size_t)size.QuadPart;
+#else
+    m->fd = open(path, O_RDONLY);
+    if (m->fd < 0) { free(m); return NULL; }
+    struct stat st;
+    if (fstat(m->fd, &st) != 0 || st.st_size == 0) { close(m->fd); free(m); return NULL; }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, m->fd, 0);
+    if (p == MAP_FAILED) { close(m->fd); free(m); return NULL; }
+    m->data = p;
+    m->size = (size_t)st.st_size;
+#endif
+    return m;
+}
+
+const unsigned char *mapfile_data(const MappedFile *m) { return m ? m->data : NULL; }
+size_t mapfile_size(const MappedFile *m) { return m ? m->size : 0; }
+
+void mapfile_close(MappedFile *m)
+{
+    if (!m) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m->data);
+    CloseHandle(m->mapping);
+    CloseHandle(m->file);
+#else
+    munmap((void *)m->data, m->size);
+    close(m->fd);
+#endif
+    free(m);
+}
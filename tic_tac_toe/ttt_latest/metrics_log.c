@@ -0,0 +1,433 @@
+// metrics_log.c — asynchronous writer for bot_metrics.csv (and the
+// click latencies of inputlat.c, which go to their own CSV)
+// botMove only copies a fixed-size record into a lock-free ring
+// (one producer: the UI thread; one consumer: the writer thread).
+// The writer formats records in batches and writes them when enough
+// have piled up or a second has passed, so the move path never waits
+// on the disk. If the ring is full the record is dropped and counted.
+//
+// Startup reads only the end of the file (for the last game number),
+// and each file is rotated once it reaches METRICS_ROTATE_BYTES
+// (bot_metrics.csv -> .1 -> .2 -> .3), so neither grows without bound.
+// A file whose header doesn't match the current columns is rotated out
+// at startup instead of being appended to.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define METRICS_RING       1024    // records, power of two
+#define METRICS_BATCH      64      // wake the writer at this many pending
+#define METRICS_FLUSH_MS   1000    // ... or after this long
+#define METRICS_OUT_BYTES  (1 << 16)
+#define METRICS_ROTATE_BYTES (8LL << 20)
+#define METRICS_KEEP       3       // rotated files kept
+#define METRICS_TAIL_BLOCK 4096    // read backwards from EOF in these steps
+#define METRICS_TAIL_MAX   (1 << 16)
+#define METRICS_CLICK_STAGES 8
+
+// This struct must match the one in proc_metrics.c
+typedef struct {
+    long long rssKb, peakRssKb;
+    long long userCpuUs, sysCpuUs;
+    long long volCtxSwitches, involCtxSwitches;
+} ProcMetrics;
+
+enum { REC_MOVE, REC_CLICK };
+
+typedef struct {
+    int kind;               // REC_MOVE -> bot_metrics.csv, REC_CLICK -> the clicks file
+    int game;
+    int move;               // ply for a click
+    char bot[24];
+    union {
+        struct {
+            double micros;          // time_taken_per_move
+            long long memKb;        // process_memory_kb
+            long long memDiff;      // mem_diff
+            long long peakKb;       // peak_memory_kb
+            long long userUs;       // user_cpu_us, this move only
+            long long sysUs;        // sys_cpu_us
+            long long volCtx;       // vol_ctx_switches
+            long long involCtx;     // invol_ctx_switches
+            long long nodes;        // nodes searched, -1 = the bot doesn't search
+        };
+        double stageUs[METRICS_CLICK_STAGES];   // see metrics_log_click
+    };
+} MetricRecord;
+
+static MetricRecord ring[METRICS_RING];
+static SDL_atomic_t ringHead;      // next slot to fill (producer)
+static SDL_atomic_t ringTail;      // next slot to write (writer)
+static SDL_atomic_t dropped;       // records lost to a full ring
+static int droppedReported = 0;    // writer only
+
+// The files belong to the writer thread once it runs (rotation swaps
+// them); producers only look at these flags, set and cleared by the
+// thread that opens and closes the log.
+static int logging = 0;            // metrics_log_open() succeeded
+static int clicksOn = 0;           // ... and so did metrics_log_open_clicks()
+
+typedef struct {
+    FILE *f;
+    long long bytes;               // size of the current file
+    char path[512];
+    char header[256];
+} MetricsFile;
+
+static MetricsFile moveLog;        // bot_metrics.csv
+static MetricsFile clickLog;       // input_latency.csv
+static SDL_Thread *writer = NULL;
+static SDL_mutex *wakeLock = NULL;
+static SDL_cond *wake = NULL;
+static SDL_atomic_t stopping;
+
+void metrics_log_close(void);
+
+// Zone profiler (trace.c)
+extern SDL_atomic_t traceOn;
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+void trace_thread_name(const char *name);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
+
+static size_t metrics_format(const MetricRecord *r, char *buf, size_t size)
+{
+    int n = snprintf(buf, size, "%d,%d,%s,%.0f,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n",
+                     r->game, r->move, r->bot, r->micros, r->memKb, r->memDiff,
+                     r->peakKb, r->userUs, r->sysUs, r->volCtx, r->involCtx, r->nodes);
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+static size_t metrics_format_click(const MetricRecord *r, char *buf, size_t size)
+{
+    const double *s = r->stageUs;
+    int n = snprintf(buf, size, "%d,%d,%s,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n",
+                     r->game, r->move, r->bot, s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7]);
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+static long long metrics_file_size(FILE *f)
+{
+#ifdef _WIN32
+    _fseeki64(f, 0, SEEK_END);
+    return _ftelli64(f);
+#else
+    fseeko(f, 0, SEEK_END);
+    return (long long)ftello(f);
+#endif
+}
+
+// Game number of the last record in f, read backwards from the end
+// (never more than METRICS_TAIL_MAX bytes). 0 if there is none.
+static int metrics_last_game(FILE *f)
+{
+    static char buf[METRICS_TAIL_MAX + 1];
+    long long size = metrics_file_size(f);
+    long long want = METRICS_TAIL_BLOCK;
+    for (;;) {
+        long long len = (size < want) ? size : want;
+        if (len <= 0) return 0;
+#ifdef _WIN32
+        _fseeki64(f, size - len, SEEK_SET);
+#else
+        fseeko(f, (off_t)(size - len), SEEK_SET);
+#endif
+        if (fread(buf, 1, (size_t)len, f) != (size_t)len) return 0;
+        buf[len] = '\0';
+
+        // last line that starts with a number (a cut-off first line doesn't count)
+        long long end = len;
+        for (;;) {
+            while (end > 0 && (buf[end - 1] == '\n' || buf[end - 1] == '\r')) end--;
+            if (end == 0) break;
+            long long start = end;
+            while (start > 0 && buf[start - 1] != '\n') start--;
+            if (start == 0 && len < size) break;         // may be cut off: read more
+            if (buf[start] >= '0' && buf[start] <= '9') return atoi(buf + start);
+            if (start == 0) break;
+            end = start;
+        }
+        if (len == size || want >= METRICS_TAIL_MAX) return 0;
+        want *= 4;
+        if (want > METRICS_TAIL_MAX) want = METRICS_TAIL_MAX;
+    }
+}
+
+static FILE *metrics_open_file(MetricsFile *m)
+{
+    m->f = fopen(m->path, "a+b");  // one handle: read the tail, append records
+    if (!m->f) return NULL;
+    m->bytes = metrics_file_size(m->f);
+    if (m->bytes == 0) {
+        fputs(m->header, m->f);
+        fflush(m->f);
+        m->bytes = (long long)strlen(m->header);
+    }
+    return m->f;
+}
+
+// 1 if f starts with exactly this header line
+static int metrics_header_matches(FILE *f, const char *header)
+{
+    char line[256];
+    rewind(f);
+    if (!fgets(line, sizeof line, f)) return 0;
+    return strcmp(line, header) == 0;
+}
+
+// path -> path.1 -> .2 ..., dropping the oldest. Starts a new file.
+static void metrics_rotate(MetricsFile *m)
+{
+    char from[600], to[600];
+    fclose(m->f);
+    m->f = NULL;
+    snprintf(to, sizeof to, "%s.%d", m->path, METRICS_KEEP);
+    remove(to);
+    for (int i = METRICS_KEEP - 1; i >= 1; --i) {
+        snprintf(from, sizeof from, "%s.%d", m->path, i);
+        snprintf(to, sizeof to, "%s.%d", m->path, i + 1);
+        rename(from, to);
+    }
+    snprintf(to, sizeof to, "%s.1", m->path);
+    rename(m->path, to);
+    metrics_open_file(m);
+}
+
+// Opens m for appending, rotating it out first if it is full or was
+// written with other columns. Returns 0 if it can't be opened.
+static int metrics_file_start(MetricsFile *m, const char *path, const char *header)
+{
+    snprintf(m->path, sizeof m->path, "%s", path);
+    snprintf(m->header, sizeof m->header, "%s", header);
+    if (!metrics_open_file(m)) return 0;
+    if (m->bytes >= METRICS_ROTATE_BYTES || !metrics_header_matches(m->f, header))
+        metrics_rotate(m);
+    return m->f != NULL;
+}
+
+static void metrics_write(MetricsFile *m, const char *buf, size_t len)
+{
+    if (m->f && len) fwrite(buf, 1, len, m->f);
+    m->bytes += (long long)len;
+}
+
+// Writes what is left of a drained batch; flushes and rotates m if
+// anything went to it.
+static void metrics_finish(MetricsFile *m, const char *buf, size_t len, int records)
+{
+    metrics_write(m, buf, len);
+    if (!m->f || !records) return;
+    fflush(m->f);
+    if (m->bytes >= METRICS_ROTATE_BYTES) metrics_rotate(m);
+}
+
+// Formats and writes everything in the ring; buf and clickBuf are
+// METRICS_OUT_BYTES each. Returns records written.
+static int metrics_drain(char *buf, char *clickBuf)
+{
+    TRACE_BEGIN("metrics_drain", "logging");
+    int tail = SDL_AtomicGet(&ringTail);
+    int head = SDL_AtomicGet(&ringHead);
+    SDL_MemoryBarrierAcquire();            // see the records before head
+    size_t used = 0, clickUsed = 0;
+    int n = 0, clicks = 0;
+    for (; tail != head; ++tail, ++n) {
+        const MetricRecord *r = &ring[tail & (METRICS_RING - 1)];
+        if (r->kind == REC_CLICK) {
+            if (clickUsed + 128 > METRICS_OUT_BYTES) {
+                metrics_write(&clickLog, clickBuf, clickUsed);
+                clickUsed = 0;
+            }
+            clickUsed += metrics_format_click(r, clickBuf + clickUsed, METRICS_OUT_BYTES - clickUsed);
+            clicks++;
+            continue;
+        }
+        if (used + 128 > METRICS_OUT_BYTES) {
+            metrics_write(&moveLog, buf, used);
+            used = 0;
+        }
+        used += metrics_format(r, buf + used, METRICS_OUT_BYTES - used);
+    }
+    SDL_MemoryBarrierRelease();            // done reading before freeing slots
+    SDL_AtomicSet(&ringTail, tail);
+    metrics_finish(&moveLog, buf, used, n - clicks);
+    metrics_finish(&clickLog, clickBuf, clickUsed, clicks);
+
+    int lost = SDL_AtomicGet(&dropped);
+    if (lost != droppedReported) {
+        fprintf(stderr, "[metrics] %d record(s) dropped, the writer fell behind.\n", lost - droppedReported);
+        droppedReported = lost;
+    }
+    TRACE_END();
+    return n;
+}
+
+static int metrics_writer(void *unused)
+{
+    static char buf[METRICS_OUT_BYTES], clickBuf[METRICS_OUT_BYTES];
+    (void)unused;
+    trace_thread_name("metrics");
+    for (;;) {
+        SDL_LockMutex(wakeLock);
+        if (!SDL_AtomicGet(&stopping) &&
+            SDL_AtomicGet(&ringHead) - SDL_AtomicGet(&ringTail) < METRICS_BATCH)
+            SDL_CondWaitTimeout(wake, wakeLock, METRICS_FLUSH_MS);
+        SDL_UnlockMutex(wakeLock);
+
+        int stop = SDL_AtomicGet(&stopping);
+        metrics_drain(buf, clickBuf);
+        if (stop) break;
+    }
+    metrics_drain(buf, clickBuf);          // anything queued while stopping
+    return 0;
+}
+
+// Opens (appending) the metrics CSV, writing the header into a new
+// file, and starts the writer thread. *lastGame gets the game number
+// of the last record logged so far. Returns 0 if it can't be opened.
+int metrics_log_open(const char *path, const char *header, int *lastGame)
+{
+    static int registered = 0;
+    if (logging) return 1;
+    if (!metrics_file_start(&moveLog, path, header)) return 0;
+
+    *lastGame = metrics_last_game(moveLog.f);
+    if (*lastGame == 0) {           // just rotated: continue from the previous file
+        char prev[600];
+        snprintf(prev, sizeof prev, "%s.1", path);
+        FILE *p = fopen(prev, "rb");
+        if (p) { *lastGame = metrics_last_game(p); fclose(p); }
+    }
+    metrics_file_size(moveLog.f);   // seek to the end: the writer's fwrite follows reads
+    if (!registered) {      // some screens exit() straight from SDL_QUIT
+        atexit(metrics_log_close);
+        registered = 1;
+    }
+    SDL_AtomicSet(&ringHead, 0);
+    SDL_AtomicSet(&ringTail, 0);
+    SDL_AtomicSet(&dropped, 0);
+    SDL_AtomicSet(&stopping, 0);
+    droppedReported = 0;
+    wakeLock = SDL_CreateMutex();
+    wake = SDL_CreateCond();
+    writer = (wakeLock && wake) ? SDL_CreateThread(metrics_writer, "metrics", NULL) : NULL;
+    logging = 1;
+    return 1;
+}
+
+// Opens (appending) a second CSV for click latencies, written by the
+// same thread and rotated the same way. Call before metrics_log_open().
+// Returns 0 if it can't be opened.
+int metrics_log_open_clicks(const char *path, const char *header)
+{
+    if (clicksOn) return 1;
+    if (logging) return 0;
+    if (!metrics_file_start(&clickLog, path, header)) return 0;
+    clicksOn = 1;
+    return 1;
+}
+
+static long long metrics_delta(long long now, long long before)
+{
+    return (now < 0 || before < 0) ? -1 : now - before;
+}
+
+// Next free ring slot, or NULL (not logging, or the ring is full:
+// counted as dropped). Producer side only.
+static MetricRecord *metrics_slot(void)
+{
+    if (!logging) return NULL;
+    int head = SDL_AtomicGet(&ringHead);
+    if (head - SDL_AtomicGet(&ringTail) >= METRICS_RING) {
+        SDL_AtomicAdd(&dropped, 1);
+        return NULL;
+    }
+    SDL_MemoryBarrierAcquire();            // writer is done with this slot
+    return &ring[head & (METRICS_RING - 1)];
+}
+
+// Makes the record in the slot from metrics_slot() visible to the
+// writer, and wakes it once a batch has piled up.
+static void metrics_publish(void)
+{
+    int head = SDL_AtomicGet(&ringHead);
+    int pending = head - SDL_AtomicGet(&ringTail);
+    SDL_MemoryBarrierRelease();            // publish the record before head
+    SDL_AtomicSet(&ringHead, head + 1);
+
+    if (!writer) {                         // no thread: write inline
+        static char buf[METRICS_OUT_BYTES], clickBuf[METRICS_OUT_BYTES];
+        metrics_drain(buf, clickBuf);
+    } else if (pending + 1 == METRICS_BATCH) {
+        SDL_LockMutex(wakeLock);
+        SDL_CondSignal(wake);
+        SDL_UnlockMutex(wakeLock);
+    }
+}
+
+// Queues one bot move (UI thread). Never blocks on I/O. 'before' is
+// sampled before the move; counters a platform lacks are logged as -1.
+void metrics_log_move(int game, int move, const char *bot, double micros, long long nodes,
+                      const ProcMetrics *now, const ProcMetrics *before)
+{
+    MetricRecord *r = metrics_slot();
+    if (!r) return;
+    r->kind = REC_MOVE;
+    r->game = game;
+    r->move = move;
+    strncpy(r->bot, bot, sizeof r->bot - 1);
+    r->bot[sizeof r->bot - 1] = '\0';
+    r->micros = micros;
+    r->memKb = now->rssKb;
+    r->memDiff = metrics_delta(now->rssKb, before->rssKb);
+    r->peakKb = now->peakRssKb;
+    r->userUs = metrics_delta(now->userCpuUs, before->userCpuUs);
+    r->sysUs = metrics_delta(now->sysCpuUs, before->sysCpuUs);
+    r->volCtx = metrics_delta(now->volCtxSwitches, before->volCtxSwitches);
+    r->involCtx = metrics_delta(now->involCtxSwitches, before->involCtxSwitches);
+    r->nodes = nodes;
+    metrics_publish();
+}
+
+// Queues one click's latency stages in us (UI thread): queue, handle,
+// update, ai, render, present, anim, total. Never blocks on I/O.
+void metrics_log_click(int game, int ply, const char *bot, const double stageUs[])
+{
+    if (!clicksOn) return;
+    MetricRecord *r = metrics_slot();
+    if (!r) return;
+    r->kind = REC_CLICK;
+    r->game = game;
+    r->move = ply;
+    strncpy(r->bot, bot, sizeof r->bot - 1);
+    r->bot[sizeof r->bot - 1] = '\0';
+    memcpy(r->stageUs, stageUs, sizeof r->stageUs);
+    metrics_publish();
+}
+
+// Writes out everything queued, stops the writer and closes the files.
+void metrics_log_close(void)
+{
+    if (!logging && !clicksOn) return;
+    logging = clicksOn = 0;             // producers stop queueing
+    if (writer) {
+        SDL_LockMutex(wakeLock);
+        SDL_AtomicSet(&stopping, 1);
+        SDL_CondSignal(wake);
+        SDL_UnlockMutex(wakeLock);
+        SDL_WaitThread(writer, NULL);
+        writer = NULL;
+    }
+    int lost = SDL_AtomicGet(&dropped);
+    if (lost) fprintf(stderr, "[metrics] %d record(s) were dropped this session.\n", lost);
+    if (moveLog.f) fclose(moveLog.f);
+    moveLog.f = NULL;
+    if (clickLog.f) fclose(clickLog.f);
+    clickLog.f = NULL;
+    if (wake) SDL_DestroyCond(wake);
+    if (wakeLock) SDL_DestroyMutex(wakeLock);
+    wake = NULL;
+    wakeLock = NULL;
+}
@@ -0,0 +1,323 @@
+// notation.c — games as text, one per line
+//   [mp|easy|medium|hard] X:b2 O:a1 X:c3 ... <result>
+// A square is its column letter (a..c, left to right) and row number
+// (1..3, top to bottom), so a1 is the top-left corner. The result is
+// 1-0 (X won), 0-1 (O won), 1/2-1/2 (draw) or * (unfinished). The
+// leading tag says who played: mp = two players, easy/medium/hard =
+// against the bot at that difficulty (omitted = mp). Text after '#'
+// is a comment.
+//
+// Export streams games.log through a fixed output buffer; import reads
+// the text in fixed blocks, parses each line in place and replays it
+// through playback_record_move / playback_finalize_game, so memory use
+// doesn't depend on the size of the archive.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// This enum must match the one in main.c
+typedef enum { EMPTY=0, X=1, O=2 } Cell;
+
+void playback_init(void);
+void playback_shutdown(void);
+void playback_set_bulk(int on, int learn);
+void playback_begin_new_game(void);
+void playback_record_move(int row, int col, Cell piece);
+void playback_finalize_game(int mode, int difficulty);
+
+// Naive Bayes model (N_bayes.c)
+void nb_train_from_file(const char* path);
+int  nb_load_snapshot(const char *path);
+void nb_hold_snapshots(int on);
+void nb_flush_snapshot(void);
+
+// Read-only file mapping (mapfile.c)
+typedef struct MappedFile MappedFile;
+MappedFile *mapfile_open(const char *path);
+const unsigned char *mapfile_data(const MappedFile *m);
+size_t mapfile_size(const MappedFile *m);
+void mapfile_close(MappedFile *m);
+
+#define NOTATION_BLOCK   (1 << 16)   // import read size
+#define NOTATION_OUT     (1 << 20)   // export buffer
+#define NOTATION_MAXLINE 256         // longest line we'll accept
+
+// games.log layout (see playback.c)
+#define GAMELOG_HEADER_SIZE 16
+#define GAMELOG_RECORD_SIZE 24
+
+// mode / difficulty as passed to playback_finalize_game
+static const char *const modeTags[4] = { "easy", "medium", "hard", "mp" };
+
+static int notation_winner(const Cell b[9])
+{
+    static const int lines[8][3] = {
+        {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6}
+    };
+    for (int i = 0; i < 8; ++i) {
+        Cell v = b[lines[i][0]];
+        if (v != EMPTY && v == b[lines[i][1]] && v == b[lines[i][2]]) return v;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------
+// Export
+// ---------------------------------------------------------------
+
+// Writes one games.log record as a line. Returns bytes written (< 64).
+static int notation_format(const unsigned char *rec, char *out)
+{
+    int n = rec[8], winner = rec[9], mode = rec[10], diff = rec[11];
+    char *p = out;
+    const char *tag = (mode == 2 && diff <= 2) ? modeTags[diff] : modeTags[3];
+    size_t tagLen = strlen(tag);
+
+    memcpy(p, tag, tagLen);
+    p += tagLen;
+    if (n > 9) n = 9;
+    for (int i = 0; i < n; ++i) {
+        int sq = rec[12 + i] & 0x0F, piece = rec[12 + i] >> 4;
+        if (sq > 8) sq = 8;
+        *p++ = ' ';
+        *p++ = (piece == O) ? 'O' : 'X';
+        *p++ = ':';
+        *p++ = (char)('a' + sq % 3);
+        *p++ = (char)('1' + sq / 3);
+    }
+    const char *result = (winner == X) ? " 1-0\n" : (winner == O) ? " 0-1\n"
+                       : (n == 9) ? " 1/2-1/2\n" : " *\n";
+    size_t resultLen = strlen(result);
+    memcpy(p, result, resultLen);
+    return (int)(p - out) + (int)resultLen;
+}
+
+// Returns the number of games written, or -1 on error.
+static long long notation_export(const char *logPath, const char *outPath)
+{
+    MappedFile *log = mapfile_open(logPath);
+    if (!log || mapfile_size(log) < GAMELOG_HEADER_SIZE ||
+        memcmp(mapfile_data(log), "TTTGAMES", 8) != 0) {
+        fprintf(stderr, "[notation] '%s' is not a game log.\n", logPath);
+        if (log) mapfile_close(log);
+        return -1;
+    }
+    int toStdout = (strcmp(outPath, "-") == 0);
+    FILE *out = toStdout ? stdout : fopen(outPath, "wb");
+    char *buf = malloc(NOTATION_OUT);
+    if (!out || !buf) {
+        fprintf(stderr, "[notation] Cannot write '%s'.\n", outPath);
+        if (out && !toStdout) fclose(out);
+        free(buf);
+        mapfile_close(log);
+        return -1;
+    }
+
+    const unsigned char *recs = mapfile_data(log) + GAMELOG_HEADER_SIZE;
+    long long games = (long long)((mapfile_size(log) - GAMELOG_HEADER_SIZE) / GAMELOG_RECORD_SIZE);
+    size_t used = 0;
+    int failed = 0;
+    for (long long g = 0; g < games; ++g) {
+        if (used + 64 > NOTATION_OUT) {
+            failed |= fwrite(buf, 1, used, out) != used;
+            used = 0;
+        }
+        used += (size_t)notation_format(recs + g * GAMELOG_RECORD_SIZE, buf + used);
+    }
+    failed |= fwrite(buf, 1, used, out) != used;
+    failed |= toStdout ? fflush(out) != 0 : fclose(out) != 0;
+    free(buf);
+    mapfile_close(log);
+    if (failed) {
+        fprintf(stderr, "[notation] Could not write all of '%s'.\n", outPath);
+        return -1;
+    }
+    return games;
+}
+
+// ---------------------------------------------------------------
+// Import
+// ---------------------------------------------------------------
+typedef struct {
+    int n;
+    int squares[9];
+    Cell pieces[9];
+    int mode, difficulty;
+} NotationGame;
+
+static int notation_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parses one line (not NUL-terminated, no '\n') into g.
+// Returns 1 for a game, 0 for a blank/comment line, -1 if malformed.
+static int notation_parse_line(const char *s, const char *end, NotationGame *g)
+{
+    Cell b[9] = {EMPTY};
+    int result = -1;            // winner claimed by the result tag, 3 = unfinished
+    g->n = 0;
+    g->mode = 1;                // MODE_MP
+    g->difficulty = 0xFF;
+
+    for (;;) {
+        while (s < end && notation_space(*s)) s++;
+        if (s == end || *s == '#') break;
+        const char *tok = s;
+        while (s < end && !notation_space(*s) && *s != '#') s++;
+        size_t len = (size_t)(s - tok);
+
+        if (result >= 0) return -1;                          // nothing after the result
+        if (len == 4 && tok[1] == ':' && (tok[0] == 'X' || tok[0] == 'O' ||
+                                          tok[0] == 'x' || tok[0] == 'o')) {
+            int col = tok[2] - 'a', row = tok[3] - '1';
+            Cell piece = (tok[0] == 'X' || tok[0] == 'x') ? X : O;
+            if (col < 0 || col > 2 || row < 0 || row > 2 || g->n >= 9) return -1;
+            int sq = row * 3 + col;
+            if (b[sq] != EMPTY || notation_winner(b)) return -1;  // taken / game over
+            if (g->n > 0 && piece == g->pieces[g->n - 1]) return -1;  // must alternate
+            b[sq] = piece;
+            g->squares[g->n] = sq;
+            g->pieces[g->n] = piece;
+            g->n++;
+        } else if (len == 3 && memcmp(tok, "1-0", 3) == 0)     result = X;
+        else if (len == 3 && memcmp(tok, "0-1", 3) == 0)       result = O;
+        else if (len == 7 && memcmp(tok, "1/2-1/2", 7) == 0)   result = 0;
+        else if (len == 1 && tok[0] == '*')                    result = 3;
+        else if (g->n == 0) {                                  // leading tag
+            int m = -1;
+            for (int i = 0; i < 4; ++i)
+                if (len == strlen(modeTags[i]) && memcmp(tok, modeTags[i], len) == 0) m = i;
+            if (m < 0) return -1;
+            g->mode = (m == 3) ? 1 : 2;
+            g->difficulty = (m == 3) ? 0xFF : m;
+        } else {
+            return -1;
+        }
+    }
+    if (result < 0) return g->n ? -1 : 0;
+    // the result has to agree with the moves
+    int winner = notation_winner(b);
+    if (result == 3) return winner ? -1 : 1;
+    if (result != winner) return -1;
+    if (result == 0 && g->n < 9) return -1;
+    return 1;
+}
+
+static void notation_replay(const NotationGame *g)
+{
+    playback_begin_new_game();
+    for (int i = 0; i < g->n; ++i)
+        playback_record_move(g->squares[i] / 3, g->squares[i] % 3, g->pieces[i]);
+    playback_finalize_game(g->mode, g->difficulty);
+}
+
+// Reads games from path ("-" = stdin) into the history.
+// Returns the games imported, or -1 if the input can't be read.
+static long long notation_import(const char *path, long long *badLines)
+{
+    int fromStdin = (strcmp(path, "-") == 0);
+    FILE *in = fromStdin ? stdin : fopen(path, "rb");
+    char *buf = malloc(NOTATION_BLOCK);
+    if (!in || !buf) {
+        fprintf(stderr, "[notation] Cannot read '%s'.\n", path);
+        if (in && !fromStdin) fclose(in);
+        free(buf);
+        return -1;
+    }
+
+    NotationGame g;
+    long long games = 0, lineNo = 0;
+    size_t have = 0;
+    int skippingLong = 0;       // inside a line longer than NOTATION_MAXLINE
+    *badLines = 0;
+    for (;;) {
+        size_t got = fread(buf + have, 1, NOTATION_BLOCK - have, in);
+        size_t len = have + got, i = 0;
+        if (len == 0) break;
+
+        while (i < len) {
+            char *nl = memchr(buf + i, '\n', len - i);
+            if (!nl) {
+                if (got > 0 && len - i <= NOTATION_MAXLINE) break;  // read the rest
+                if (got > 0) {                                      // runaway line
+                    if (!skippingLong) { lineNo++; (*badLines)++; }
+                    skippingLong = 1;
+                    i = len;
+                    break;
+                }
+                nl = buf + len;                                     // last line
+            }
+            if (skippingLong) {
+                skippingLong = 0;
+            } else {
+                lineNo++;
+                int r = ((size_t)(nl - (buf + i)) > NOTATION_MAXLINE) ? -1
+                      : notation_parse_line(buf + i, nl, &g);
+                if (r > 0) {
+                    notation_replay(&g);
+                    games++;
+                } else if (r < 0) {
+                    if (++(*badLines) <= 5)
+                        fprintf(stderr, "[notation] %s:%lld: not a valid game, skipped.\n", path, lineNo);
+                }
+            }
+            i = (size_t)(nl - buf) + 1;
+        }
+        if (got == 0) break;
+        if (i > len) i = len;
+        memmove(buf, buf + i, len - i);     // keep the partial line
+        have = len - i;
+    }
+    if (ferror(in)) fprintf(stderr, "[notation] Read error in '%s'.\n", path);
+    if (!fromStdin) fclose(in);
+    free(buf);
+    return games;
+}
+
+// ---------------------------------------------------------------
+// Command-line tool
+// ---------------------------------------------------------------
+static void notation_usage(const char *exe)
+{
+    fprintf(stderr,
+            "usage: %s --export-games <out.txt|-> [games.log]\n"
+            "       %s --import-games <in.txt|-> [--learn]\n",
+            exe, exe);
+}
+
+// ttt.exe --export-games / --import-games (see notation_usage). Returns the exit code.
+int notation_main(int argc, char *argv[])
+{
+    if (argc < 3) { notation_usage(argv[0]); return 1; }
+    Uint64 t0 = SDL_GetPerformanceCounter();
+
+    if (strcmp(argv[1], "--export-games") == 0) {
+        long long games = notation_export((argc > 3) ? argv[3] : "games.log", argv[2]);
+        if (games < 0) return 1;
+        double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+        fprintf(stderr, "Exported %lld games in %.2f s\n", games, secs);
+        return 0;
+    }
+
+    int learn = (argc > 3 && strcmp(argv[3], "--learn") == 0);
+    long long bad = 0;
+    if (learn) {                        // add to the saved model, as the game does
+        if (!nb_load_snapshot("nb_model.dat"))
+            nb_train_from_file("tic-tac-toe.data");
+        nb_hold_snapshots(1);
+    }
+    playback_init();
+    playback_set_bulk(1, learn);        // without --learn the bot doesn't learn from archives
+    long long games = notation_import(argv[2], &bad);
+    playback_set_bulk(0, 0);
+    playback_shutdown();
+    if (learn) {
+        nb_hold_snapshots(0);
+        nb_flush_snapshot();
+    }
+    if (games < 0) return 1;
+
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    printf("Imported %lld games (%lld lines skipped) in %.2f s, %.0f games/s\n",
+           games, bad, secs, secs > 0 ? games / secs : 0.0);
+    return 0;
+}
@@ -1,4 +1,10 @@
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <SDL2/SDL.h>
 
 // This enum must match the one in main.c
 typedef enum { EMPTY=0, X=1, O=2 } Cell;
@@ -15,9 +21,213 @@ typedef struct {
 static Move currentMoves[9];
 static int  currentMoveCount = 0;
 
-// Snapshot of last completed game
+// Online Naive Bayes learning (N_bayes.c)
+void nb_learn_from_game(const int squares[], const Cell pieces[], int n);
+
+// Position index over the logged games (posindex.c)
+void posindex_init(long long loggedGames);
+void posindex_add_game(unsigned gameId, const int squares[], const Cell pieces[], int n, int winner);
+void posindex_flush(void);
+void posindex_shutdown(void);
+
+// Background analysis of finished games (analysis.c)
+void analysis_request(unsigned gameId, const int squares[], const Cell pieces[], int n);
+void analysis_shutdown(void);
+
+// Zone profiler (trace.c)
+extern SDL_atomic_t traceOn;
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
+
+// Read-only file mapping (mapfile.c)
+typedef struct MappedFile MappedFile;
+MappedFile *mapfile_open(const char *path);
+const unsigned char *mapfile_data(const MappedFile *m);
+size_t mapfile_size(const MappedFile *m);
+void mapfile_close(MappedFile *m);
+
+// Game currently shown by playback (last finished game by default)
 static Move lastMoves[9];
 static int  lastMoveCount = 0;
+static int  lastGameId = 0;
+
+// Board after each step of that game (frames[0] is the empty board),
+// built once when the game is loaded, and the playback cursor.
+static Cell frames[10][3][3];
+static int  cursorStep = 0;
+static Cell cursorBoard[3][3];
+
+// ---------------------------------------------------------------
+// Game history log
+// games.log is append-only: a 16-byte header, then one fixed-size
+// GameRecord per finished game, so game N lives at a known offset.
+// Finished games go to an in-memory ring of recent games and are
+// written in batches; older games are read through a file mapping.
+// Records are stored little-endian (x86 / x64).
+// ---------------------------------------------------------------
+#define GAMELOG_PATH        "games.log"
+#define GAMELOG_HEADER_SIZE 16
+#define GAMELOG_RECENT      64    // games kept in memory
+#define GAMELOG_BATCH       16    // games per disk write (must be < GAMELOG_RECENT)
+
+static const char gamelogMagic[8] = { 'T','T','T','G','A','M','E','S' };
+
+typedef struct {
+    uint32_t gameId;      // 1-based, record i on disk holds game i+1
+    uint32_t endTime;     // time() when the game finished
+    uint8_t  moveCount;
+    uint8_t  winner;      // 0 draw, 1 X, 2 O
+    uint8_t  mode;        // GameMode: 1 multiplayer, 2 single player
+    uint8_t  difficulty;  // Difficulty 0..2, 0xFF in multiplayer
+    uint8_t  moves[9];    // r*3+c in the low nibble, piece in the high nibble
+    uint8_t  reserved[3];
+} GameRecord;
+
+typedef char gamelog_record_is_24_bytes[(sizeof(GameRecord) == 24) ? 1 : -1];
+
+static FILE *logFile = NULL;          // NULL = history not persisted
+static long  loggedGames = 0;         // records on disk
+static long  totalGames = 0;          // on disk + pending
+static GameRecord recent[GAMELOG_RECENT];
+static int   recentHead = 0;          // next slot to overwrite
+static int   recentCount = 0;
+static GameRecord pending[GAMELOG_BATCH];
+static int   pendingCount = 0;
+static MappedFile *logMap = NULL;     // view of the records on disk
+static long  mappedGames = 0;
+static int   bulkMode = 0;            // importing: no analysis / per-game indexing
+static int   bulkLearn = 0;           // ... but the easy bot still learns
+
+void playback_shutdown(void);
+
+static int gamelog_seek(long record)
+{
+    long long off = GAMELOG_HEADER_SIZE + (long long)record * (long long)sizeof(GameRecord);
+#ifdef _WIN32
+    return _fseeki64(logFile, off, SEEK_SET);
+#else
+    return fseeko(logFile, (off_t)off, SEEK_SET);
+#endif
+}
+
+// Writes the pending batch after the last whole record on disk
+// (a torn record from a crash gets overwritten).
+static void gamelog_flush(void)
+{
+    if (!logFile || pendingCount == 0) return;
+    TRACE_BEGIN("gamelog_flush", "logging");
+    if (gamelog_seek(loggedGames) == 0 &&
+        fwrite(pending, sizeof(GameRecord), (size_t)pendingCount, logFile) == (size_t)pendingCount &&
+        fflush(logFile) == 0) {
+        loggedGames += pendingCount;
+        posindex_flush();       // index postings never get ahead of the log
+    } else {
+        fprintf(stderr, "[playback] Could not write %s, history is memory-only now.\n", GAMELOG_PATH);
+        fclose(logFile);
+        logFile = NULL;
+    }
+    pendingCount = 0;
+    TRACE_END();
+}
+
+// Opens (or creates) the history log. Only the header is read, so this
+// is instant however long the history is.
+void playback_init(void)
+{
+    static int registered = 0;
+    if (logFile) return;
+    if (!registered) {      // some screens exit() straight from SDL_QUIT
+        atexit(playback_shutdown);
+        registered = 1;
+    }
+    logFile = fopen(GAMELOG_PATH, "r+b");
+    if (!logFile) {
+        logFile = fopen(GAMELOG_PATH, "w+b");
+        if (!logFile) return;
+        unsigned char header[GAMELOG_HEADER_SIZE] = {0};
+        uint32_t recSize = (uint32_t)sizeof(GameRecord);
+        memcpy(header, gamelogMagic, sizeof gamelogMagic);
+        memcpy(header + 8, &recSize, sizeof recSize);
+        if (fwrite(header, 1, sizeof header, logFile) != sizeof header || fflush(logFile) != 0) {
+            fclose(logFile);
+            logFile = NULL;
+            return;
+        }
+        posindex_init(0);
+        return;
+    }
+
+    unsigned char header[GAMELOG_HEADER_SIZE];
+    uint32_t recSize = 0;
+    if (fread(header, 1, sizeof header, logFile) != sizeof header ||
+        memcmp(header, gamelogMagic, sizeof gamelogMagic) != 0 ||
+        (memcpy(&recSize, header + 8, sizeof recSize), recSize != sizeof(GameRecord))) {
+        fprintf(stderr, "[playback] %s is not a game log, history won't be saved.\n", GAMELOG_PATH);
+        fclose(logFile);
+        logFile = NULL;
+        return;
+    }
+#ifdef _WIN32
+    _fseeki64(logFile, 0, SEEK_END);
+    long long size = _ftelli64(logFile);
+#else
+    fseeko(logFile, 0, SEEK_END);
+    long long size = (long long)ftello(logFile);
+#endif
+    loggedGames = (long)((size - GAMELOG_HEADER_SIZE) / (long long)sizeof(GameRecord));
+    totalGames  = loggedGames;
+    posindex_init(loggedGames);
+}
+
+// Writes out the pending batch and releases the log (on exit).
+// Safe to call more than once.
+void playback_shutdown(void)
+{
+    gamelog_flush();
+    analysis_shutdown();
+    posindex_shutdown();
+    if (logMap) { mapfile_close(logMap); logMap = NULL; mappedGames = 0; }
+    if (logFile) { fclose(logFile); logFile = NULL; }
+}
+
+// Finds game 'index' (0 = oldest). Returns NULL if it isn't available.
+static const GameRecord *gamelog_get(long index)
+{
+    if (index < 0 || index >= totalGames) return NULL;
+
+    long back = totalGames - 1 - index;            // 0 = newest
+    if (back < recentCount) {
+        int slot = (recentHead - 1 - (int)back + GAMELOG_RECENT) % GAMELOG_RECENT;
+        return &recent[slot];
+    }
+    if (index >= loggedGames) return NULL;
+    if (index >= mappedGames) {                    // log grew since we mapped it
+        if (logMap) mapfile_close(logMap);
+        logMap = mapfile_open(GAMELOG_PATH);
+        size_t size = mapfile_size(logMap);
+        mappedGames = (size > GAMELOG_HEADER_SIZE)
+                    ? (long)((size - GAMELOG_HEADER_SIZE) / sizeof(GameRecord)) : 0;
+        if (index >= mappedGames) return NULL;
+    }
+    return (const GameRecord *)(mapfile_data(logMap) + GAMELOG_HEADER_SIZE) + index;
+}
+
+// Rebuilds the per-step frames for lastMoves and rewinds the cursor
+static void playback_load_frames(void)
+{
+    memset(frames[0], 0, sizeof frames[0]);
+    for (int i = 0; i < lastMoveCount; ++i) {
+        memcpy(frames[i + 1], frames[i], sizeof frames[i]);
+        int r = lastMoves[i].row;
+        int c = lastMoves[i].col;
+        if (r >= 0 && r < 3 && c >= 0 && c < 3)
+            frames[i + 1][r][c] = lastMoves[i].piece;
+    }
+    cursorStep = 0;
+    memcpy(cursorBoard, frames[0], sizeof cursorBoard);
+}
 
 // Called whenever a NEW game starts (board cleared for a new round)
 void playback_begin_new_game(void)
@@ -37,19 +247,125 @@ void playback_record_move(int row, int col, Cell piece)
     currentMoveCount++;
 }
 
-// Called when a game ends (win or draw)
-void playback_finalize_game(void)
+static int moves_winner(const Move *moves, int n)
+{
+    Cell b[9] = {EMPTY};
+    for (int i = 0; i < n; ++i) b[moves[i].row * 3 + moves[i].col] = moves[i].piece;
+    static const int lines[8][3] = {
+        {0,1,2}, {3,4,5}, {6,7,8}, {0,3,6}, {1,4,7}, {2,5,8}, {0,4,8}, {2,4,6}
+    };
+    for (int i = 0; i < 8; ++i) {
+        Cell v = b[lines[i][0]];
+        if (v != EMPTY && v == b[lines[i][1]] && v == b[lines[i][2]]) return v;
+    }
+    return 0;
+}
+
+// Called when a game ends (win or draw). mode/difficulty are the
+// GameMode and Difficulty the game was played with.
+void playback_finalize_game(int mode, int difficulty)
 {
+    int squares[9];
+    Cell pieces[9];
+
     lastMoveCount = currentMoveCount;
     for (int i = 0; i < lastMoveCount; ++i) {
         lastMoves[i] = currentMoves[i];
+        squares[i] = currentMoves[i].row * 3 + currentMoves[i].col;
+        pieces[i]  = currentMoves[i].piece;
+    }
+
+    // let the easy bot learn from every finished game
+    if (!bulkMode || bulkLearn) nb_learn_from_game(squares, pieces, lastMoveCount);
+    playback_load_frames();
+
+    // add it to the history
+    GameRecord rec;
+    memset(&rec, 0, sizeof rec);
+    rec.gameId     = (uint32_t)(totalGames + 1);
+    rec.endTime    = (uint32_t)time(NULL);
+    rec.moveCount  = (uint8_t)lastMoveCount;
+    rec.winner     = (uint8_t)moves_winner(lastMoves, lastMoveCount);
+    rec.mode       = (uint8_t)mode;
+    rec.difficulty = (mode == 2) ? (uint8_t)difficulty : 0xFF;
+    for (int i = 0; i < lastMoveCount; ++i)
+        rec.moves[i] = (uint8_t)(squares[i] | (pieces[i] << 4));
+
+    recent[recentHead] = rec;
+    recentHead = (recentHead + 1) % GAMELOG_RECENT;
+    if (recentCount < GAMELOG_RECENT) recentCount++;
+    totalGames++;
+    lastGameId = (int)rec.gameId;
+    if (!bulkMode) analysis_request(rec.gameId, squares, pieces, lastMoveCount);
+
+    if (logFile) {
+        if (!bulkMode) posindex_add_game(rec.gameId, squares, pieces, lastMoveCount, rec.winner);
+        pending[pendingCount++] = rec;
+        if (pendingCount == GAMELOG_BATCH) gamelog_flush();
+    }
+
+    // the next round records from an empty move list
+    currentMoveCount = 0;
+}
+
+// Bulk mode is for importing many games at once: they go into the
+// history (and, with learn, the easy bot's model) but are not analysed
+// or indexed one by one. The position index catches up from games.log
+// when it ends.
+void playback_set_bulk(int on, int learn)
+{
+    if (bulkMode && !on && logFile) {
+        gamelog_flush();
+        posindex_shutdown();
+        posindex_init(loggedGames);
     }
+    bulkMode = on;
+    bulkLearn = on && learn;
 }
 
 // Returns non-zero if we have a completed (or at least played) game stored
 int playback_has_last_game(void)
 {
-    return (lastMoveCount > 0);
+    return (totalGames > 0);
+}
+
+// Number of games in the history (this session and earlier ones)
+int playback_game_count(void)
+{
+    return (int)totalGames;
+}
+
+// Loads a game from the history for playback: 0 = most recent,
+// 1 = the one before, ... Returns 0 if that game isn't available.
+int playback_select_game(int back)
+{
+    const GameRecord *rec = gamelog_get(totalGames - 1 - back);
+    if (!rec) return 0;
+
+    lastMoveCount = (rec->moveCount <= 9) ? rec->moveCount : 9;
+    for (int i = 0; i < lastMoveCount; ++i) {
+        lastMoves[i].row   = (rec->moves[i] & 0x0F) / 3;
+        lastMoves[i].col   = (rec->moves[i] & 0x0F) % 3;
+        lastMoves[i].piece = (Cell)(rec->moves[i] >> 4);
+    }
+    lastGameId = (int)rec->gameId;
+    playback_load_frames();
+
+    // older games get analysed when first viewed
+    int squares[9];
+    Cell pieces[9];
+    for (int i = 0; i < lastMoveCount; ++i) {
+        squares[i] = lastMoves[i].row * 3 + lastMoves[i].col;
+        pieces[i]  = lastMoves[i].piece;
+    }
+    analysis_request(rec->gameId, squares, pieces, lastMoveCount);
+    return 1;
+}
+
+// Id (1-based game number) of the game playback is showing
+int playback_selected_game_id(void)
+{
+    return lastGameId;
 }
 
 // Number of moves in the last game
@@ -58,28 +374,61 @@ int playback_get_move_count(void)
     return lastMoveCount;
 }
 
-// Build/modify board state outBoard.
+// Build/modify board state outBoard (copies the precomputed frame).
 void playback_build_board_at_step(int step, Cell outBoard[3][3])
 {
     if (!outBoard)
         return;
 
-    // RESET BOARD TO EMPTY
-    for (int r = 0; r < 3; ++r)
-        for (int c = 0; c < 3; ++c)
-            outBoard[r][c] = EMPTY;
-
     if (step < 0)
         step = 0;
     if (step > lastMoveCount)
         step = lastMoveCount;
-    //NESTED LOOP TO REPLAY STEP BY STEP
-    for (int i = 0; i < step; ++i) {
-        int r = lastMoves[i].row;
-        int c = lastMoves[i].col;
-        Cell p = lastMoves[i].piece;
-        if (r >= 0 && r < 3 && c >= 0 && c < 3) {
-            outBoard[r][c] = p;
-        }
-    }
+    memcpy(outBoard, frames[step], sizeof frames[step]);
+}
+
+// ---------------------------------------------------------------
+// Playback cursor: moves one step at a time by applying / undoing a
+// single move, or jumps anywhere by copying a frame. Never replays.
+// ---------------------------------------------------------------
+
+// Step the cursor is on (0 = empty board, move count = final board)
+int playback_cursor_step(void)
+{
+    return cursorStep;
+}
+
+// Board at the cursor
+void playback_cursor_board(Cell outBoard[3][3])
+{
+    memcpy(outBoard, cursorBoard, sizeof cursorBoard);
+}
+
+// Applies the next move. Returns 0 if already at the end.
+int playback_step_forward(void)
+{
+    if (cursorStep >= lastMoveCount) return 0;
+    const Move *m = &lastMoves[cursorStep++];
+    if (m->row >= 0 && m->row < 3 && m->col >= 0 && m->col < 3)
+        cursorBoard[m->row][m->col] = m->piece;
+    return 1;
+}
+
+// Undoes the last applied move. Returns 0 if already at the start.
+int playback_step_back(void)
+{
+    if (cursorStep <= 0) return 0;
+    const Move *m = &lastMoves[--cursorStep];
+    if (m->row >= 0 && m->row < 3 && m->col >= 0 && m->col < 3)
+        cursorBoard[m->row][m->col] = EMPTY;
+    return 1;
+}
+
+// Jumps straight to a step (clamped to the game)
+void playback_seek(int step)
+{
+    if (step < 0) step = 0;
+    if (step > lastMoveCount) step = lastMoveCount;
+    cursorStep = step;
+    memcpy(cursorBoard, frames[step], sizeof cursorBoard);
 }
@@ -0,0 +1,672 @@
+// posindex.c — which recorded games passed through a position
+// Every board reached in a logged game is filed under its canonical
+// code (board_canonical_code in N_bayes.c, so rotations/reflections
+// share an entry) with a posting (game id, ply, result).
+// There are only 3^9 codes, so the "hash" is a direct-addressed table.
+// Each code also keeps how many of its games were draws / X / O wins,
+// so a lookup reads a few counters; only listing games walks postings.
+//
+// Files, next to games.log:
+//   games.pidx      base segment: postings grouped by code, mapped read-only
+//     header (32 bytes) | uint64 offsets[PIDX_CODES + 1]
+//     | uint64 results[PIDX_CODES][3] | Posting[]
+//   games.pidx.log  delta: games finished since the last merge, appended
+//     with the game log (header 16 bytes | per game: DeltaGame, DeltaEntry[])
+//     Each game is a length-checked frame (empty games too, so ids stay
+//     contiguous); a torn or corrupt tail is cut off on load.
+// The delta is folded into a new base segment once it gets large, or
+// after it had to be repaired.
+// Everything is little-endian (x86 / x64).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// This enum must match the one in main.c
+typedef enum { EMPTY=0, X=1, O=2 } Cell;
+
+int board_canonical_code(const int feat[9]);   // N_bayes.c
+
+// Read-only file mapping (mapfile.c)
+typedef struct MappedFile MappedFile;
+MappedFile *mapfile_open(const char *path);
+const unsigned char *mapfile_data(const MappedFile *m);
+size_t mapfile_size(const MappedFile *m);
+void mapfile_close(MappedFile *m);
+
+#define PIDX_PATH         "games.pidx"
+#define PIDX_DELTA_PATH   "games.pidx.log"
+#define PIDX_LOG_PATH     "games.log"
+#define PIDX_CODES        19683
+#define PIDX_HEADER_SIZE  32
+#define PIDX_DELTA_HEADER 16
+#define PIDX_MERGE_AT     (1 << 18)   // delta postings before a merge
+#define PIDX_CATCHUP_MAX  4096        // unindexed games added one by one; more -> rebuild
+
+// games.log layout (see playback.c)
+#define GAMELOG_HEADER_SIZE 16
+#define GAMELOG_RECORD_SIZE 24
+
+static const char pidxMagic[8]  = { 'T','T','T','P','I','D','X','2' };
+static const char deltaMagic[8] = { 'T','T','T','P','D','L','T','2' };
+
+typedef struct {
+    uint32_t gameId;
+    uint8_t  ply;        // moves made when the position was reached
+    uint8_t  result;     // 0 draw, 1 X won, 2 O won
+    uint16_t reserved;
+} Posting;
+
+// delta in memory
+typedef struct {
+    uint32_t gameId;
+    uint16_t code;
+    uint8_t  ply;
+    uint8_t  result;
+} DeltaPosting;
+
+// delta on disk
+typedef struct {
+    uint32_t gameId;
+    uint8_t  count;      // DeltaEntry records that follow (0..9)
+    uint8_t  result;
+    uint16_t check;      // pidx_frame_check() of the frame
+} DeltaGame;
+
+typedef struct {
+    uint16_t code;
+    uint8_t  ply;
+    uint8_t  reserved;
+} DeltaEntry;
+
+static int pidxReady = 0;
+
+// base segment
+static MappedFile *baseMap = NULL;
+static const uint64_t *baseOff = NULL;
+static const uint64_t *baseResults = NULL;   // [code * 3 + result]
+static const Posting *basePost = NULL;
+static long long baseGames = 0;
+
+// delta: in memory as one linked list per code
+static DeltaPosting *delta = NULL;
+static int *deltaNext = NULL;
+static int deltaHead[PIDX_CODES], deltaTail[PIDX_CODES];
+static long long deltaResults[PIDX_CODES][3];
+static int deltaCount = 0, deltaCap = 0;
+static unsigned char *frames = NULL;    // frames not yet in games.pidx.log
+static size_t framesLen = 0, framesCap = 0;
+static long long deltaBytes = PIDX_DELTA_HEADER;   // good frames on disk end here
+static FILE *deltaFile = NULL;
+static long long indexedGames = 0;
+
+static int pidx_delta_push(uint32_t gameId, int code, int ply, int result)
+{
+    if (deltaCount == deltaCap) {
+        int cap = deltaCap ? deltaCap * 2 : 1024;
+        DeltaPosting *d = realloc(delta, sizeof *d * (size_t)cap);
+        if (!d) return 0;
+        delta = d;
+        int *n = realloc(deltaNext, sizeof *n * (size_t)cap);
+        if (!n) return 0;
+        deltaNext = n;
+        deltaCap = cap;
+    }
+    int i = deltaCount++;
+    delta[i].gameId = gameId;
+    delta[i].code   = (uint16_t)code;
+    delta[i].ply    = (uint8_t)ply;
+    delta[i].result = (uint8_t)result;
+    deltaNext[i] = -1;
+    if (deltaHead[code] < 0) deltaHead[code] = i;
+    else deltaNext[deltaTail[code]] = i;
+    deltaTail[code] = i;
+    deltaResults[code][result]++;
+    return 1;
+}
+
+static void pidx_delta_clear(void)
+{
+    for (int c = 0; c < PIDX_CODES; ++c) deltaHead[c] = deltaTail[c] = -1;
+    memset(deltaResults, 0, sizeof deltaResults);
+    deltaCount = 0;
+    framesLen = 0;
+    deltaBytes = PIDX_DELTA_HEADER;
+}
+
+// FNV-1a of the frame (check field taken as 0), folded to 16 bits
+static uint16_t pidx_frame_check(DeltaGame g, const DeltaEntry *e)
+{
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)&g;
+    g.check = 0;
+    for (size_t i = 0; i < sizeof g; ++i) h = (h ^ p[i]) * 16777619u;
+    p = (const unsigned char *)e;
+    for (size_t i = 0; i < sizeof *e * g.count; ++i) h = (h ^ p[i]) * 16777619u;
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+static long long pidx_file_end(FILE *f)
+{
+#ifdef _WIN32
+    _fseeki64(f, 0, SEEK_END);
+    return _ftelli64(f);
+#else
+    fseeko(f, 0, SEEK_END);
+    return (long long)ftello(f);
+#endif
+}
+
+static int pidx_truncate(FILE *f, long long size)
+{
+    if (fflush(f) != 0) return 0;
+#ifdef _WIN32
+    return _chsize_s(_fileno(f), size) == 0;
+#else
+    return ftruncate(fileno(f), (off_t)size) == 0;
+#endif
+}
+
+// Calls fn for every position (ply 1..n) of a game given as squares
+// r*3+c and pieces. Returns 0 if the game isn't a legal sequence.
+static int pidx_for_each_position(const int squares[], const Cell pieces[], int n,
+                                  void (*fn)(int code, int ply, void *ctx), void *ctx)
+{
+    int feat[9] = {0};
+    if (n < 0 || n > 9) return 0;
+    for (int i = 0; i < n; ++i) {
+        if (squares[i] < 0 || squares[i] > 8 || feat[squares[i]] != EMPTY ||
+            (pieces[i] != X && pieces[i] != O)) return 0;
+    }
+    for (int i = 0; i < n; ++i) {
+        feat[squares[i]] = pieces[i];
+        fn(board_canonical_code(feat), i + 1, ctx);
+    }
+    return 1;
+}
+
+// Unpacks record r of a mapped games.log. Returns the move count, or -1.
+static int pidx_log_record(const unsigned char *log, long long r, int squares[9], Cell pieces[9], int *winner)
+{
+    const unsigned char *rec = log + GAMELOG_HEADER_SIZE + r * GAMELOG_RECORD_SIZE;
+    int n = rec[8];
+    if (n > 9 || rec[9] > 2) return -1;
+    for (int i = 0; i < n; ++i) {
+        squares[i] = rec[12 + i] & 0x0F;
+        pieces[i]  = (Cell)(rec[12 + i] >> 4);
+    }
+    *winner = rec[9];
+    return n;
+}
+
+// ---------------------------------------------------------------
+// Base segment
+// ---------------------------------------------------------------
+static void pidx_unmap_base(void)
+{
+    if (baseMap) mapfile_close(baseMap);
+    baseMap = NULL;
+    baseOff = NULL;
+    baseResults = NULL;
+    basePost = NULL;
+    baseGames = 0;
+}
+
+static int pidx_map_base(void)
+{
+    pidx_unmap_base();
+    MappedFile *map = mapfile_open(PIDX_PATH);
+    if (!map) return 0;
+    const unsigned char *p = mapfile_data(map);
+    size_t size = mapfile_size(map);
+    uint64_t games = 0, postings = 0;
+    size_t tableEnd = PIDX_HEADER_SIZE + sizeof(uint64_t) * (PIDX_CODES + 1 + PIDX_CODES * 3);
+    if (size < tableEnd || memcmp(p, pidxMagic, sizeof pidxMagic) != 0) {
+        mapfile_close(map);
+        return 0;
+    }
+    memcpy(&games, p + 8, sizeof games);
+    memcpy(&postings, p + 16, sizeof postings);
+    const uint64_t *off = (const uint64_t *)(p + PIDX_HEADER_SIZE);
+    if (off[PIDX_CODES] != postings || tableEnd + postings * sizeof(Posting) > size) {
+        mapfile_close(map);
+        return 0;
+    }
+    baseMap = map;
+    baseOff = off;
+    baseResults = off + PIDX_CODES + 1;
+    basePost = (const Posting *)(p + tableEnd);
+    baseGames = (long long)games;
+    return 1;
+}
+
+typedef struct {
+    uint64_t *count;        // per code (pass 1) / write cursor (pass 2)
+    uint64_t *results;      // per code and result (pass 2)
+    Posting *out;
+    uint32_t gameId;
+    int result;
+} PidxFill;
+
+static void pidx_count_position(int code, int ply, void *ctx)
+{
+    PidxFill *f = ctx;
+    (void)ply;
+    f->count[code]++;
+}
+
+static void pidx_fill_position(int code, int ply, void *ctx)
+{
+    PidxFill *f = ctx;
+    Posting *p = &f->out[f->count[code]++];
+    p->gameId = f->gameId;
+    p->ply = (uint8_t)ply;
+    p->result = (uint8_t)f->result;
+    p->reserved = 0;
+    f->results[code * 3 + f->result]++;
+}
+
+// Writes a new base segment and empties the delta. With a log, the
+// postings of every game in it are rebuilt; without one, the current
+// base and delta are merged. Returns 0 on failure (index unchanged).
+static int pidx_write_base(const unsigned char *log, long long logGames)
+{
+    uint64_t *off = calloc(PIDX_CODES + 1, sizeof *off);
+    uint64_t *cur = calloc(PIDX_CODES, sizeof *cur);
+    uint64_t *results = calloc(PIDX_CODES * 3, sizeof *results);
+    Posting *post = NULL;
+    long long games = log ? logGames : indexedGames;
+    int squares[9], winner, n;
+    Cell pieces[9];
+    PidxFill f;
+    if (!off || !cur || !results) { free(off); free(cur); free(results); return 0; }
+
+    // pass 1: postings per code
+    f.count = off + 1;
+    if (log) {
+        for (long long r = 0; r < logGames; ++r)
+            if ((n = pidx_log_record(log, r, squares, pieces, &winner)) >= 0)
+                pidx_for_each_position(squares, pieces, n, pidx_count_position, &f);
+    } else {
+        for (int c = 0; c < PIDX_CODES; ++c)
+            if (baseOff) f.count[c] = baseOff[c + 1] - baseOff[c];
+        for (int i = 0; i < deltaCount; ++i) f.count[delta[i].code]++;
+    }
+    for (int c = 0; c < PIDX_CODES; ++c) off[c + 1] += off[c];
+    if (off[PIDX_CODES]) post = malloc(sizeof *post * (size_t)off[PIDX_CODES]);
+    if (off[PIDX_CODES] && !post) { free(off); free(cur); free(results); return 0; }
+
+    // pass 2: fill, keeping each code's postings in game order
+    memcpy(cur, off, sizeof *cur * PIDX_CODES);
+    f.count = cur;
+    f.results = results;
+    f.out = post;
+    if (log) {
+        for (long long r = 0; r < logGames; ++r) {
+            if ((n = pidx_log_record(log, r, squares, pieces, &winner)) < 0) continue;
+            f.gameId = (uint32_t)(r + 1);
+            f.result = winner;
+            pidx_for_each_position(squares, pieces, n, pidx_fill_position, &f);
+        }
+    } else {
+        for (int c = 0; c < PIDX_CODES; ++c) {
+            if (baseOff) {
+                uint64_t k = baseOff[c + 1] - baseOff[c];
+                memcpy(post + cur[c], basePost + baseOff[c], sizeof *post * (size_t)k);
+                cur[c] += k;
+                for (int r = 0; r < 3; ++r) results[c * 3 + r] = baseResults[c * 3 + r];
+            }
+            for (int i = deltaHead[c]; i >= 0; i = deltaNext[i]) {
+                Posting *p = &post[cur[c]++];
+                p->gameId = delta[i].gameId;
+                p->ply = delta[i].ply;
+                p->result = delta[i].result;
+                p->reserved = 0;
+                results[c * 3 + p->result]++;
+            }
+        }
+    }
+
+    const char *tmp = PIDX_PATH ".tmp";
+    FILE *out = fopen(tmp, "wb");
+    int failed = (out == NULL);
+    if (out) {
+        unsigned char header[PIDX_HEADER_SIZE] = {0};
+        uint64_t g = (uint64_t)games, total = off[PIDX_CODES];
+        memcpy(header, pidxMagic, sizeof pidxMagic);
+        memcpy(header + 8, &g, sizeof g);
+        memcpy(header + 16, &total, sizeof total);
+        failed |= fwrite(header, 1, sizeof header, out) != sizeof header;
+        failed |= fwrite(off, sizeof *off, PIDX_CODES + 1, out) != PIDX_CODES + 1;
+        failed |= fwrite(results, sizeof *results, PIDX_CODES * 3, out) != PIDX_CODES * 3;
+        if (total) failed |= fwrite(post, sizeof *post, (size_t)total, out) != (size_t)total;
+        failed |= fclose(out) != 0;
+    }
+    free(off);
+    free(cur);
+    free(results);
+    free(post);
+    if (failed) { remove(tmp); return 0; }
+
+    pidx_unmap_base();        // Windows can't replace a mapped file
+    remove(PIDX_PATH);
+    if (rename(tmp, PIDX_PATH) != 0 || !pidx_map_base()) {
+        remove(tmp);
+        return 0;
+    }
+
+    // the delta is now part of the base: start a fresh one
+    pidx_delta_clear();
+    indexedGames = baseGames;
+    if (deltaFile) fclose(deltaFile);
+    deltaFile = fopen(PIDX_DELTA_PATH, "w+b");
+    if (deltaFile) {
+        unsigned char header[PIDX_DELTA_HEADER] = {0};
+        memcpy(header, deltaMagic, sizeof deltaMagic);
+        if (fwrite(header, 1, sizeof header, deltaFile) != sizeof header || fflush(deltaFile) != 0) {
+            fclose(deltaFile);
+            deltaFile = NULL;
+        }
+    }
+    return 1;
+}
+
+// Rebuilds the whole index from games.log. Returns the games indexed, or -1.
+static long long pidx_rebuild_from_log(void)
+{
+    MappedFile *log = mapfile_open(PIDX_LOG_PATH);
+    long long games = 0;
+    if (log && mapfile_size(log) >= GAMELOG_HEADER_SIZE)
+        games = (long long)((mapfile_size(log) - GAMELOG_HEADER_SIZE) / GAMELOG_RECORD_SIZE);
+    if (!log) {                 // no games: write an empty index
+        pidx_unmap_base();
+        pidx_delta_clear();
+        indexedGames = 0;
+    }
+    int ok = pidx_write_base(log ? mapfile_data(log) : NULL, games);
+    if (log) mapfile_close(log);
+    return ok ? games : -1;
+}
+
+// ---------------------------------------------------------------
+// Incremental updates (driven by playback.c)
+// ---------------------------------------------------------------
+typedef struct {
+    uint32_t gameId;
+    int result;
+    DeltaEntry entries[9];
+    int n;
+} PidxAdd;
+
+static void pidx_add_position(int code, int ply, void *ctx)
+{
+    PidxAdd *a = ctx;
+    pidx_delta_push(a->gameId, code, ply, a->result);
+    a->entries[a->n].code = (uint16_t)code;
+    a->entries[a->n].ply = (uint8_t)ply;
+    a->entries[a->n].reserved = 0;
+    a->n++;
+}
+
+// Queues the frame of a game for the next posindex_flush().
+static void pidx_frame_append(const PidxAdd *a)
+{
+    DeltaGame g = { a->gameId, (uint8_t)a->n, (uint8_t)a->result, 0 };
+    size_t size = sizeof g + sizeof(DeltaEntry) * (size_t)a->n;
+    if (framesLen + size > framesCap) {
+        size_t cap = framesCap ? framesCap * 2 : 4096;
+        unsigned char *f = realloc(frames, cap);
+        if (!f) return;
+        frames = f;
+        framesCap = cap;
+    }
+    g.check = pidx_frame_check(g, a->entries);
+    memcpy(frames + framesLen, &g, sizeof g);
+    memcpy(frames + framesLen + sizeof g, a->entries, size - sizeof g);
+    framesLen += size;
+}
+
+// Files the positions of a finished game (gameId = its 1-based number
+// in games.log; winner 0 draw, 1 X, 2 O).
+void posindex_add_game(unsigned gameId, const int squares[], const Cell pieces[], int n, int winner)
+{
+    if (!pidxReady || (long long)gameId != indexedGames + 1) return;   // keep ids contiguous
+    PidxAdd a;
+    a.gameId = (uint32_t)gameId;
+    a.result = winner;
+    a.n = 0;
+    pidx_for_each_position(squares, pieces, n, pidx_add_position, &a);
+    pidx_frame_append(&a);     // illegal or empty games get an empty frame
+    indexedGames = gameId;
+}
+
+// Appends the games added since the last flush to games.pidx.log.
+// playback.c calls this right after writing a batch of games.log.
+void posindex_flush(void)
+{
+    if (!deltaFile) framesLen = 0;
+    if (framesLen == 0) return;
+#ifdef _WIN32
+    int sought = _fseeki64(deltaFile, deltaBytes, SEEK_SET) == 0;
+#else
+    int sought = fseeko(deltaFile, (off_t)deltaBytes, SEEK_SET) == 0;
+#endif
+    if (sought && fwrite(frames, 1, framesLen, deltaFile) == framesLen && fflush(deltaFile) == 0) {
+        deltaBytes += (long long)framesLen;
+        framesLen = 0;
+    } else {
+        fclose(deltaFile);        // next start catches up from games.log
+        deltaFile = NULL;
+    }
+}
+
+// Opens the index for a game log holding loggedGames games. Anything
+// the index is missing is added from games.log (or rebuilt if a lot is).
+void posindex_init(long long loggedGames)
+{
+    if (pidxReady) return;
+    pidx_delta_clear();
+    int haveBase = pidx_map_base();
+    indexedGames = baseGames;
+
+    // reload the delta; a torn or corrupt tail, or games past the game
+    // log, are cut off (and caught up from games.log below)
+    int repaired = 0;
+    deltaFile = haveBase ? fopen(PIDX_DELTA_PATH, "r+b") : NULL;
+    if (deltaFile) {
+        unsigned char header[PIDX_DELTA_HEADER];
+        if (fread(header, 1, sizeof header, deltaFile) != sizeof header ||
+            memcmp(header, deltaMagic, sizeof deltaMagic) != 0) {
+            fclose(deltaFile);
+            deltaFile = NULL;
+        }
+    }
+    if (deltaFile) {
+        long long good = PIDX_DELTA_HEADER;
+        DeltaGame g;
+        DeltaEntry e[9];
+        while (fread(&g, sizeof g, 1, deltaFile) == 1) {
+            if (g.count > 9 || g.result > 2 || g.gameId != indexedGames + 1 || g.gameId > loggedGames ||
+                fread(e, sizeof *e, g.count, deltaFile) != g.count || pidx_frame_check(g, e) != g.check) break;
+            int ok = 1;
+            for (int i = 0; i < g.count; ++i) ok &= (e[i].code < PIDX_CODES);
+            if (!ok) break;
+            for (int i = 0; i < g.count; ++i) pidx_delta_push(g.gameId, e[i].code, e[i].ply, g.result);
+            indexedGames = g.gameId;
+            good += (long long)(sizeof g + sizeof *e * g.count);
+        }
+        if (pidx_file_end(deltaFile) > good) {
+            repaired = 1;
+            if (!pidx_truncate(deltaFile, good)) {
+                fclose(deltaFile);
+                deltaFile = NULL;
+            }
+        }
+        deltaBytes = good;
+    }
+
+    if (!haveBase || !deltaFile || baseGames > loggedGames ||
+        loggedGames - indexedGames > PIDX_CATCHUP_MAX) {
+        if (pidx_rebuild_from_log() < 0) {
+            fprintf(stderr, "[posindex] Could not build %s.\n", PIDX_PATH);
+            pidx_unmap_base();
+            return;
+        }
+    } else if (indexedGames < loggedGames) {
+        // a few games were logged but not indexed (crash between writes)
+        MappedFile *log = mapfile_open(PIDX_LOG_PATH);
+        int squares[9], winner, n;
+        Cell pieces[9];
+        long long have = 0;
+        if (log && mapfile_size(log) >= GAMELOG_HEADER_SIZE)
+            have = (long long)((mapfile_size(log) - GAMELOG_HEADER_SIZE) / GAMELOG_RECORD_SIZE);
+        pidxReady = 1;
+        for (long long r = indexedGames; r < loggedGames && r < have; ++r) {
+            if ((n = pidx_log_record(mapfile_data(log), r, squares, pieces, &winner)) < 0) n = winner = 0;
+            posindex_add_game((unsigned)(r + 1), squares, pieces, n, winner);
+        }
+        if (log) mapfile_close(log);
+        posindex_flush();
+    }
+    if (repaired || deltaCount >= PIDX_MERGE_AT) pidx_write_base(NULL, 0);
+    pidxReady = 1;
+}
+
+// Flushes the delta, merges it if it got large, and closes the index.
+void posindex_shutdown(void)
+{
+    if (!pidxReady) return;
+    posindex_flush();
+    if (deltaCount >= PIDX_MERGE_AT) pidx_write_base(NULL, 0);
+    if (deltaFile) { fclose(deltaFile); deltaFile = NULL; }
+    pidx_unmap_base();
+    free(delta);
+    free(deltaNext);
+    free(frames);
+    delta = NULL;
+    deltaNext = NULL;
+    frames = NULL;
+    deltaCount = deltaCap = 0;
+    framesLen = framesCap = 0;
+    pidxReady = 0;
+}
+
+// ---------------------------------------------------------------
+// Lookups
+// ---------------------------------------------------------------
+
+static int pidx_board_code(const Cell board[3][3])
+{
+    int feat[9];
+    for (int i = 0; i < 9; ++i) feat[i] = board[i / 3][i % 3];
+    return board_canonical_code(feat);
+}
+
+// Calls fn(gameId, ply, result) for every game that reached this board
+// (or a rotation/reflection of it), oldest first. Returns the count.
+long long posindex_postings(const Cell board[3][3],
+                            void (*fn)(unsigned gameId, int ply, int result, void *ctx), void *ctx)
+{
+    if (!pidxReady) return 0;
+    int code = pidx_board_code(board);
+    long long n = 0;
+
+    if (baseOff) {
+        for (uint64_t k = baseOff[code]; k < baseOff[code + 1]; ++k, ++n)
+            if (fn) fn(basePost[k].gameId, basePost[k].ply, basePost[k].result, ctx);
+    }
+    for (int i = deltaHead[code]; i >= 0; i = deltaNext[i], ++n)
+        if (fn) fn(delta[i].gameId, delta[i].ply, delta[i].result, ctx);
+    return n;
+}
+
+// Number of games that reached this board; results[] gets draws,
+// X wins and O wins among them. Reads the per-code counters only.
+long long posindex_lookup(const Cell board[3][3], long long results[3])
+{
+    results[0] = results[1] = results[2] = 0;
+    if (!pidxReady) return 0;
+    int code = pidx_board_code(board);
+    for (int r = 0; r < 3; ++r) {
+        if (baseResults) results[r] = (long long)baseResults[code * 3 + r];
+        results[r] += deltaResults[code][r];
+    }
+    return results[0] + results[1] + results[2];
+}
+
+// ---------------------------------------------------------------
+// Command-line tool
+// ---------------------------------------------------------------
+typedef struct {
+    long long printed, limit;
+} PidxListCtx;
+
+static void pidx_list_game(unsigned gameId, int ply, int result, void *ctx)
+{
+    static const char *const resultNames[3] = { "draw", "X won", "O won" };
+    PidxListCtx *lc = ctx;
+    if (lc->printed++ < lc->limit)
+        printf("  game %u, move %d, %s\n", gameId, ply, resultNames[result]);
+}
+
+static void pidx_usage(const char *exe)
+{
+    fprintf(stderr,
+            "usage: %s --posindex-build\n"
+            "       %s --posindex-query <board> [--list N]\n"
+            "       board = 9 cells row by row, each x, o or - (e.g. x---o----)\n",
+            exe, exe);
+}
+
+// ttt.exe --posindex-build / --posindex-query (see pidx_usage). Returns the exit code.
+int posindex_main(int argc, char *argv[])
+{
+    if (strcmp(argv[1], "--posindex-build") == 0) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        long long games = pidx_rebuild_from_log();
+        if (deltaFile) { fclose(deltaFile); deltaFile = NULL; }
+        if (games < 0) {
+            fprintf(stderr, "[posindex] Could not build %s.\n", PIDX_PATH);
+            return 1;
+        }
+        double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+        printf("Position index: %lld games, %llu postings -> '%s' (%.2f s)\n",
+               games, (unsigned long long)baseOff[PIDX_CODES], PIDX_PATH, secs);
+        pidx_unmap_base();
+        return 0;
+    }
+
+    if (argc < 3 || strlen(argv[2]) != 9) { pidx_usage(argv[0]); return 1; }
+    Cell board[3][3];
+    for (int i = 0; i < 9; ++i) {
+        char ch = argv[2][i];
+        board[i / 3][i % 3] = (ch == 'x' || ch == 'X') ? X : (ch == 'o' || ch == 'O') ? O : EMPTY;
+    }
+    PidxListCtx lc = { 0, 0 };
+    if (argc > 4 && strcmp(argv[3], "--list") == 0) lc.limit = atoll(argv[4]);
+
+    long long logged = 0;
+    MappedFile *log = mapfile_open(PIDX_LOG_PATH);
+    if (log && mapfile_size(log) >= GAMELOG_HEADER_SIZE)
+        logged = (long long)((mapfile_size(log) - GAMELOG_HEADER_SIZE) / GAMELOG_RECORD_SIZE);
+    if (log) mapfile_close(log);
+    posindex_init(logged);
+
+    long long results[3];
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    long long games = posindex_lookup(board, results);
+    double us = (double)(SDL_GetPerformanceCounter() - t0) * 1e6 / (double)SDL_GetPerformanceFrequency();
+
+    printf("%lld of %lld games reached this position (%.1f us)\n", games, indexedGames, us);
+    printf("X wins %lld, O wins %lld, draws %lld\n", results[1], results[2], results[0]);
+    if (lc.limit > 0) posindex_postings(board, pidx_list_game, &lc);
+    posindex_shutdown();
+    return 0;
+}
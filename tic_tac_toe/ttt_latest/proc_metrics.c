@@ -0,0 +1,116 @@
+// proc_metrics.c — memory / CPU / scheduling counters for this process
+// One interface, one backend per platform:
+//   Windows: GetProcessMemoryInfo + GetProcessTimes
+//   Linux:   /proc/self/statm + /proc/self/status + getrusage
+//   other POSIX: getrusage only
+// Counters a platform can't provide are -1.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+// This struct must match the one in main.c, metrics_log.c and hud.c
+typedef struct {
+    long long rssKb;          // resident set / working set
+    long long peakRssKb;
+    long long userCpuUs;      // CPU time since the process started
+    long long sysCpuUs;
+    long long volCtxSwitches;
+    long long involCtxSwitches;
+} ProcMetrics;
+
+#ifdef _WIN32
+
+static long long filetime_us(FILETIME t)
+{
+    ULARGE_INTEGER v;
+    v.LowPart = t.dwLowDateTime;
+    v.HighPart = t.dwHighDateTime;
+    return (long long)(v.QuadPart / 10);   // 100 ns units
+}
+
+int proc_metrics_sample(ProcMetrics *m)
+{
+    PROCESS_MEMORY_COUNTERS pmc;
+    FILETIME created, exited, kernel, user;
+    HANDLE self = GetCurrentProcess();
+    m->rssKb = m->peakRssKb = m->userCpuUs = m->sysCpuUs = -1;
+    m->volCtxSwitches = m->involCtxSwitches = -1;   // not exposed per process
+
+    if (GetProcessMemoryInfo(self, &pmc, sizeof(pmc))) {
+        m->rssKb = (long long)(pmc.WorkingSetSize / 1024);
+        m->peakRssKb = (long long)(pmc.PeakWorkingSetSize / 1024);
+    }
+    if (GetProcessTimes(self, &created, &exited, &kernel, &user)) {
+        m->userCpuUs = filetime_us(user);
+        m->sysCpuUs = filetime_us(kernel);
+    }
+    return m->rssKb >= 0;
+}
+
+#else
+
+#ifdef __linux__
+// The /proc files stay open; pread at offset 0 gets fresh contents
+static int statmFd = -2, statusFd = -2;   // -2 = not opened yet
+
+static long long proc_read_statm_rss_kb(void)
+{
+    char buf[128];
+    if (statmFd == -2) statmFd = open("/proc/self/statm", O_RDONLY);
+    if (statmFd < 0) return -1;
+    ssize_t n = pread(statmFd, buf, sizeof buf - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    long long size = 0, resident = 0;
+    if (sscanf(buf, "%lld %lld", &size, &resident) != 2) return -1;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long long proc_read_peak_kb(void)
+{
+    char buf[4096];
+    if (statusFd == -2) statusFd = open("/proc/self/status", O_RDONLY);
+    if (statusFd < 0) return -1;
+    ssize_t n = pread(statusFd, buf, sizeof buf - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    const char *hwm = strstr(buf, "VmHWM:");
+    return hwm ? atoll(hwm + 6) : -1;        // already in kB
+}
+#endif
+
+int proc_metrics_sample(ProcMetrics *m)
+{
+    struct rusage ru;
+    m->rssKb = m->peakRssKb = m->userCpuUs = m->sysCpuUs = -1;
+    m->volCtxSwitches = m->involCtxSwitches = -1;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        m->userCpuUs = (long long)ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec;
+        m->sysCpuUs = (long long)ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec;
+        m->volCtxSwitches = ru.ru_nvcsw;
+        m->involCtxSwitches = ru.ru_nivcsw;
+#ifdef __APPLE__
+        m->peakRssKb = ru.ru_maxrss / 1024;   // bytes on macOS
+#else
+        m->peakRssKb = ru.ru_maxrss;          // kB elsewhere
+#endif
+    }
+#ifdef __linux__
+    m->rssKb = proc_read_statm_rss_kb();
+    long long hwm = proc_read_peak_kb();
+    if (hwm >= 0) m->peakRssKb = hwm;
+#endif
+    return m->rssKb >= 0;
+}
+
+#endif
@@ -0,0 +1,251 @@
+// selfplay.c — headless engine-vs-engine dataset generator
+// Plays minimax / Naive Bayes games on every thread and streams each
+// position reached, labelled with the game's result, to disk:
+//   *.ttb  -> 2 bytes per position (see nb_scan_range_bin in N_bayes.c)
+//   other  -> the tic-tac-toe.data CSV format ("x,o,b,...,positive")
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// This enum must match the one in main.c
+typedef enum { EMPTY=0, X=1, O=2 } Cell;
+
+int  bestMove_minimax_for(Cell b[3][3], Cell aiPiece, int depthLimit, int blunderPct);
+int  bestMove_naive_bayes_r(Cell b[3][3], Cell aiPiece, unsigned tieRand);
+int  nb_load_snapshot(const char *path);
+void nb_train_from_file(const char* path);
+void nb_prepare_shared_reads(void);
+
+#define SP_MAX_THREADS  64
+#define SP_BUFFER_BYTES (1 << 20)   // per-thread output buffer
+#define SP_GAME_BATCH   256         // games claimed from the counter at once
+#define SP_CSV_ROW      27          // "x,o,b,b,b,b,b,b,b,positive\n"
+
+typedef enum { ENGINE_MINIMAX=0, ENGINE_NB=1 } Engine;
+
+typedef struct {
+    long long games;
+    int threads;
+    Engine engine[3];      // indexed by Cell (X, O)
+    int blunderPct[3];     // chance of a random legal move instead
+    int binary;
+    unsigned long long seed;
+} SelfPlayConfig;
+
+typedef struct {
+    const SelfPlayConfig *cfg;
+    FILE *out;
+    SDL_mutex *outLock;
+    SDL_atomic_t *nextGame;
+    unsigned long long rng;
+    char *buf;
+    size_t used;
+    long long games, positions;
+    long long results[3];  // draws, X wins, O wins
+    int writeFailed;
+} SelfPlayWorker;
+
+// xorshift64*: one per thread, so workers never share RNG state
+static unsigned sp_rand(unsigned long long *s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return (unsigned)((*s * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static int sp_winner(Cell b[3][3])
+{
+    for (int i = 0; i < 3; i++) {
+        if (b[i][0] && b[i][0] == b[i][1] && b[i][1] == b[i][2]) return b[i][0];
+        if (b[0][i] && b[0][i] == b[1][i] && b[1][i] == b[2][i]) return b[0][i];
+    }
+    if (b[0][0] && b[0][0] == b[1][1] && b[1][1] == b[2][2]) return b[0][0];
+    if (b[0][2] && b[0][2] == b[1][1] && b[1][1] == b[2][0]) return b[0][2];
+    return 0;
+}
+
+static void sp_flush(SelfPlayWorker *w)
+{
+    if (w->used == 0) return;
+    SDL_LockMutex(w->outLock);
+    if (fwrite(w->buf, 1, w->used, w->out) != w->used) w->writeFailed = 1;
+    SDL_UnlockMutex(w->outLock);
+    w->used = 0;
+}
+
+// Appends one labelled position to the worker's buffer
+static void sp_emit(SelfPlayWorker *w, Cell b[3][3], int xWon)
+{
+    if (w->used + SP_CSV_ROW > SP_BUFFER_BYTES) sp_flush(w);
+    char *p = w->buf + w->used;
+
+    if (w->cfg->binary) {
+        // base-3 board code in bits 0..14, label in bit 15 (little endian)
+        unsigned code = 0;
+        for (int i = 8; i >= 0; i--) code = code * 3 + b[i / 3][i % 3];
+        code |= (unsigned)xWon << 15;
+        p[0] = (char)(code & 0xFF);
+        p[1] = (char)(code >> 8);
+        w->used += 2;
+        return;
+    }
+    static const char tok[3] = { 'b', 'x', 'o' };
+    for (int i = 0; i < 9; i++) {
+        *p++ = tok[b[i / 3][i % 3]];
+        *p++ = ',';
+    }
+    memcpy(p, xWon ? "positive\n" : "negative\n", 9);
+    w->used += SP_CSV_ROW;
+}
+
+static int sp_pick_move(SelfPlayWorker *w, Cell b[3][3], Cell side)
+{
+    const SelfPlayConfig *cfg = w->cfg;
+    if ((int)(sp_rand(&w->rng) % 100) < cfg->blunderPct[side]) {
+        int empty[9], n = 0;
+        for (int i = 0; i < 9; i++) if (b[i / 3][i % 3] == EMPTY) empty[n++] = i;
+        return n ? empty[sp_rand(&w->rng) % n] : -1;
+    }
+    if (cfg->engine[side] == ENGINE_NB) return bestMove_naive_bayes_r(b, side, sp_rand(&w->rng));
+    return bestMove_minimax_for(b, side, -1, 0);   // blunders are ours, not the engine's
+}
+
+static void sp_play_game(SelfPlayWorker *w)
+{
+    Cell b[3][3] = {{EMPTY}};
+    Cell seen[9][3][3];
+    int plies = 0, winner = 0;
+    Cell side = X;
+
+    while (plies < 9) {
+        int move = sp_pick_move(w, b, side);
+        if (move < 0 || b[move / 3][move % 3] != EMPTY) break;   // engine gave up
+        b[move / 3][move % 3] = side;
+        memcpy(seen[plies++], b, sizeof b);
+        if ((winner = sp_winner(b)) != 0) break;
+        side = (side == X) ? O : X;
+    }
+    for (int i = 0; i < plies; i++) sp_emit(w, seen[i], winner == X);
+    w->positions += plies;
+    w->results[winner]++;
+    w->games++;
+}
+
+static int sp_worker(void *data)
+{
+    SelfPlayWorker *w = data;
+    for (;;) {
+        long long first = (long long)SDL_AtomicAdd(w->nextGame, SP_GAME_BATCH);
+        if (first >= w->cfg->games) break;
+        long long last = first + SP_GAME_BATCH;
+        if (last > w->cfg->games) last = w->cfg->games;
+        for (long long g = first; g < last; g++) sp_play_game(w);
+    }
+    sp_flush(w);
+    return 0;
+}
+
+// Engine named s, or -1 if there is no such engine.
+static int sp_engine_arg(const char *s)
+{
+    if (strcmp(s, "minimax") == 0) return ENGINE_MINIMAX;
+    if (strcmp(s, "nb") == 0 || strcmp(s, "naive-bayes") == 0) return ENGINE_NB;
+    return -1;
+}
+
+static void sp_usage(const char *exe)
+{
+    fprintf(stderr,
+            "usage: %s --selfplay <out.csv|out.ttb> [--games N] [--threads N]\n"
+            "          [--x minimax|nb] [--o minimax|nb] [--blunder-x P] [--blunder-o P] [--seed S]\n",
+            exe);
+}
+
+// ttt.exe --selfplay ... (see sp_usage). Returns the process exit code.
+int selfplay_main(int argc, char *argv[])
+{
+    if (argc < 3) { sp_usage(argv[0]); return 1; }
+
+    const char *outPath = argv[2];
+    SelfPlayConfig cfg = {0};
+    cfg.games = 100000;
+    cfg.engine[X] = cfg.engine[O] = ENGINE_MINIMAX;
+    cfg.blunderPct[X] = cfg.blunderPct[O] = 10;
+    cfg.seed = 1103;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const char *opt = argv[i], *val = argv[i + 1];
+        if      (strcmp(opt, "--games") == 0)     cfg.games = atoll(val);
+        else if (strcmp(opt, "--threads") == 0)   cfg.threads = atoi(val);
+        else if (strcmp(opt, "--x") == 0 || strcmp(opt, "--o") == 0) {
+            int e = sp_engine_arg(val);
+            if (e < 0) { sp_usage(argv[0]); return 1; }
+            cfg.engine[opt[2] == 'x' ? X : O] = (Engine)e;
+        }
+        else if (strcmp(opt, "--blunder-x") == 0) cfg.blunderPct[X] = atoi(val);
+        else if (strcmp(opt, "--blunder-o") == 0) cfg.blunderPct[O] = atoi(val);
+        else if (strcmp(opt, "--seed") == 0)      cfg.seed = strtoull(val, NULL, 10);
+        else { sp_usage(argv[0]); return 1; }
+    }
+    size_t len = strlen(outPath);
+    cfg.binary = (len > 4 && strcmp(outPath + len - 4, ".ttb") == 0);
+    if (cfg.games > 2000000000LL) cfg.games = 2000000000LL;   // game counter is an SDL_atomic_t
+    if (cfg.threads <= 0) cfg.threads = SDL_GetCPUCount();
+    if (cfg.threads > SP_MAX_THREADS) cfg.threads = SP_MAX_THREADS;
+    if (cfg.threads < 1) cfg.threads = 1;
+
+    if (cfg.engine[X] == ENGINE_NB || cfg.engine[O] == ENGINE_NB) {
+        if (!nb_load_snapshot("nb_model.dat"))
+            nb_train_from_file("tic-tac-toe.data");
+        nb_prepare_shared_reads();
+    }
+
+    FILE *out = fopen(outPath, "wb");
+    if (!out) {
+        fprintf(stderr, "[selfplay] Cannot open '%s'.\n", outPath);
+        return 1;
+    }
+
+    SDL_mutex *outLock = SDL_CreateMutex();
+    SDL_atomic_t nextGame;
+    SDL_AtomicSet(&nextGame, 0);
+    SelfPlayWorker workers[SP_MAX_THREADS];
+    SDL_Thread *threads[SP_MAX_THREADS];
+    memset(workers, 0, sizeof workers);
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    for (int t = 0; t < cfg.threads; t++) {
+        workers[t].cfg = &cfg;
+        workers[t].out = out;
+        workers[t].outLock = outLock;
+        workers[t].nextGame = &nextGame;
+        workers[t].rng = (cfg.seed + 1) * 0x9E3779B97F4A7C15ull + (unsigned long long)t * 0xD1B54A32D192ED03ull;
+        workers[t].buf = malloc(SP_BUFFER_BYTES);
+        threads[t] = workers[t].buf ? SDL_CreateThread(sp_worker, "selfplay", &workers[t]) : NULL;
+        if (!threads[t] && workers[t].buf) sp_worker(&workers[t]);   // no thread: play here
+    }
+
+    long long games = 0, positions = 0, results[3] = {0};
+    int failed = 0;
+    for (int t = 0; t < cfg.threads; t++) {
+        if (threads[t]) SDL_WaitThread(threads[t], NULL);
+        if (!workers[t].buf) failed = 1;
+        games     += workers[t].games;
+        positions += workers[t].positions;
+        for (int r = 0; r < 3; r++) results[r] += workers[t].results[r];
+        failed |= workers[t].writeFailed;
+        free(workers[t].buf);
+    }
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    if (fclose(out) != 0) failed = 1;
+    SDL_DestroyMutex(outLock);
+
+    printf("Self-play: %lld games, %lld positions -> '%s' (%s)\n",
+           games, positions, outPath, cfg.binary ? "binary" : "csv");
+    printf("X wins %lld, O wins %lld, draws %lld\n", results[X], results[O], results[EMPTY]);
+    printf("%.2f s on %d threads, %.0f positions/min\n",
+           secs, cfg.threads, secs > 0 ? positions / secs * 60.0 : 0.0);
+    if (failed) fprintf(stderr, "[selfplay] Some output could not be written.\n");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+// sprites.c — texture atlas for shapes that are expensive to draw
+// Icons and rounded-card corners are painted once (by the caller's paint
+// function, into an atlas render target) and then drawn with
+// SDL_RenderCopy. Sprites are identified by a caller-defined key (raw
+// bytes, so zero any padding). Shelf packing; when the atlas is full it
+// starts over. If the renderer loses its render targets the sprites are
+// painted again; if it loses the device (the atlas texture itself is
+// gone) the atlas is recreated first. sprite_clear() drops everything
+// (theme change, shutdown).
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// Zone profiler (trace.c)
+extern SDL_atomic_t traceOn;
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
+
+#define ATLAS_SIZE     1024
+#define SPRITE_MAX     256
+#define SPRITE_KEY     48        // bytes
+#define SPRITE_PAD     1         // gap between sprites
+
+typedef void (*SpritePaint)(int x, int y, const void *key);
+
+typedef struct {
+    unsigned hash;
+    int keySize;
+    unsigned char key[SPRITE_KEY];
+    SDL_Rect src;
+} Sprite;
+
+static SDL_Texture *atlas = NULL;
+static SDL_Renderer *atlasOwner = NULL;
+static int unsupported = 0;
+static SDL_atomic_t targetsLost;     // set by the event watch
+static SDL_atomic_t deviceLost;      // ... and so is this
+static Sprite sprites[SPRITE_MAX];
+static int nSprites = 0;
+static int shelfX = 0, shelfY = 0, shelfH = 0;
+
+static unsigned sp_hash(const unsigned char *p, int n)
+{
+    unsigned h = 2166136261u;   // FNV-1a
+    for (int i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+void sprite_clear(void);
+
+static int sp_watch(void *userdata, SDL_Event *e)
+{
+    (void)userdata;
+    if (e->type == SDL_RENDER_TARGETS_RESET) SDL_AtomicSet(&targetsLost, 1);
+    if (e->type == SDL_RENDER_DEVICE_RESET)  SDL_AtomicSet(&deviceLost, 1);
+    return 0;
+}
+
+static int sp_create(SDL_Renderer *r)
+{
+    if (!SDL_RenderTargetSupported(r)) { unsupported = 1; return 0; }
+    // nearest sampling: stretched nine-slice edges must not blend with neighbours
+    char quality[16];
+    const char *old = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+    snprintf(quality, sizeof quality, "%s", old ? old : "0");
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    atlas = SDL_CreateTexture(r, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                              ATLAS_SIZE, ATLAS_SIZE);
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, quality);
+    if (!atlas) { unsupported = 1; return 0; }
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    atlasOwner = r;
+    SDL_AtomicSet(&targetsLost, 0);
+    SDL_AtomicSet(&deviceLost, 0);
+    SDL_AddEventWatch(sp_watch, NULL);
+    return 1;
+}
+
+// Empties the atlas (transparent) without freeing it.
+static void sp_reset(SDL_Renderer *r)
+{
+    SDL_Texture *prev = SDL_GetRenderTarget(r);
+    Uint8 cr, cg, cb, ca;
+    SDL_BlendMode mode;
+    SDL_GetRenderDrawColor(r, &cr, &cg, &cb, &ca);
+    SDL_GetRenderDrawBlendMode(r, &mode);
+    SDL_SetRenderTarget(r, atlas);
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(r, 0, 0, 0, 0);
+    SDL_RenderClear(r);
+    SDL_SetRenderTarget(r, prev);
+    SDL_SetRenderDrawColor(r, cr, cg, cb, ca);
+    SDL_SetRenderDrawBlendMode(r, mode);
+    nSprites = 0;
+    shelfX = shelfY = shelfH = 0;
+}
+
+// Finds room for a w x h sprite. Returns 0 if the atlas is full.
+static int sp_place(int w, int h, SDL_Rect *out)
+{
+    if (w > ATLAS_SIZE || h > ATLAS_SIZE || nSprites == SPRITE_MAX) return 0;
+    if (shelfX + w > ATLAS_SIZE) {      // next shelf
+        shelfY += shelfH + SPRITE_PAD;
+        shelfX = 0;
+        shelfH = 0;
+    }
+    if (shelfY + h > ATLAS_SIZE) return 0;
+    *out = (SDL_Rect){ shelfX, shelfY, w, h };
+    shelfX += w + SPRITE_PAD;
+    if (h > shelfH) shelfH = h;
+    return 1;
+}
+
+// Looks up (or paints) the w x h sprite for 'key'. On success *tex and
+// *src say where it is; returns 0 if sprites can't be used, and the
+// caller should draw the shape directly.
+int sprite_get(SDL_Renderer *r, const void *key, int keySize, int w, int h,
+               SpritePaint paint, SDL_Texture **tex, SDL_Rect *src)
+{
+    if (unsupported || keySize > SPRITE_KEY || w <= 0 || h <= 0) return 0;
+    if (atlas && SDL_AtomicSet(&deviceLost, 0)) sprite_clear();   // texture is gone: make a new one
+    if (atlas && atlasOwner != r) return 0;        // atlas belongs to another renderer
+    if (!atlas) {
+        if (!sp_create(r)) return 0;
+        sp_reset(r);                    // new target textures start undefined
+    }
+    if (SDL_AtomicSet(&targetsLost, 0)) sp_reset(r);    // contents are gone
+
+    unsigned hash = sp_hash(key, keySize);
+    for (int i = 0; i < nSprites; ++i) {
+        Sprite *s = &sprites[i];
+        if (s->hash == hash && s->keySize == keySize && memcmp(s->key, key, (size_t)keySize) == 0) {
+            *tex = atlas;
+            *src = s->src;
+            return 1;
+        }
+    }
+
+    SDL_Rect slot;
+    if (!sp_place(w, h, &slot)) {       // full: start over
+        sp_reset(r);
+        if (!sp_place(w, h, &slot)) return 0;
+    }
+
+    TRACE_BEGIN("sprite_paint", "shape");
+    SDL_Texture *prev = SDL_GetRenderTarget(r);
+    Uint8 cr, cg, cb, ca;
+    SDL_BlendMode mode;
+    SDL_GetRenderDrawColor(r, &cr, &cg, &cb, &ca);
+    SDL_GetRenderDrawBlendMode(r, &mode);
+    SDL_SetRenderTarget(r, atlas);
+    SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+    paint(slot.x, slot.y, key);
+    SDL_SetRenderTarget(r, prev);
+    SDL_SetRenderDrawColor(r, cr, cg, cb, ca);
+    SDL_SetRenderDrawBlendMode(r, mode);
+    TRACE_END();
+
+    Sprite *s = &sprites[nSprites++];
+    s->hash = hash;
+    s->keySize = keySize;
+    memcpy(s->key, key, (size_t)keySize);
+    s->src = slot;
+    *tex = atlas;
+    *src = slot;
+    return 1;
+}
+
+// Frees the atlas; sprites are painted again on next use.
+void sprite_clear(void)
+{
+    if (atlas) {
+        SDL_DelEventWatch(sp_watch, NULL);
+        SDL_DestroyTexture(atlas);
+    }
+    atlas = NULL;
+    atlasOwner = NULL;
+    unsupported = 0;
+    nSprites = 0;
+    shelfX = shelfY = shelfH = 0;
+}
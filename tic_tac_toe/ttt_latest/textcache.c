@@ -0,0 +1,108 @@
+// textcache.c — rendered text textures, reused across frames
+// Labels are drawn every frame but rarely change, so each (text, font,
+// colour) is rasterised and uploaded once and kept until it is the least
+// recently used of TEXTCACHE_SIZE entries. Textures returned here belong
+// to the cache: callers draw them and must not destroy them.
+// textcache_clear() drops everything (theme change, shutdown).
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+// Zone profiler (trace.c)
+extern SDL_atomic_t traceOn;
+void trace_begin(const char *name, const char *cat);
+void trace_end(void);
+#define TRACE_BEGIN(name, cat) do { if (SDL_AtomicGet(&traceOn)) trace_begin(name, cat); } while (0)
+#define TRACE_END()            do { if (SDL_AtomicGet(&traceOn)) trace_end(); } while (0)
+
+#define TEXTCACHE_SIZE    64
+#define TEXTCACHE_MAXLEN  128     // longer strings aren't cached
+
+typedef struct {
+    SDL_Texture *tex;             // NULL = empty slot
+    unsigned hash;
+    unsigned lastUse;
+    TTF_Font *font;
+    Uint32 rgba;
+    char text[TEXTCACHE_MAXLEN];
+} TextEntry;
+
+static TextEntry entries[TEXTCACHE_SIZE];
+static unsigned useClock = 0;
+static SDL_Texture *uncached = NULL;   // last over-long string, freed on the next one
+static unsigned long long hits = 0, misses = 0;
+
+static unsigned tc_hash(const char *s, const TTF_Font *font, Uint32 rgba)
+{
+    unsigned h = 2166136261u ^ rgba ^ (unsigned)(size_t)font;   // FNV-1a
+    for (; *s; ++s) h = (h ^ (unsigned char)*s) * 16777619u;
+    return h;
+}
+
+static SDL_Texture *tc_render(SDL_Renderer *r, TTF_Font *font, const char *text, SDL_Color color)
+{
+    TRACE_BEGIN("createTextTexture", "text");
+    SDL_Surface *surface = TTF_RenderUTF8_Blended(font, text, color);
+    SDL_Texture *tex = surface ? SDL_CreateTextureFromSurface(r, surface) : NULL;
+    if (surface) SDL_FreeSurface(surface);
+    TRACE_END();
+    return tex;
+}
+
+// Texture for 'text' in font/colour, rendered only if it isn't cached.
+SDL_Texture *textcache_get(SDL_Renderer *r, TTF_Font *font, const char *text, SDL_Color color)
+{
+    Uint32 rgba = ((Uint32)color.r << 24) | ((Uint32)color.g << 16) | ((Uint32)color.b << 8) | color.a;
+    if (!font || !text) return NULL;
+    if (strlen(text) >= TEXTCACHE_MAXLEN) {
+        misses++;
+        if (uncached) SDL_DestroyTexture(uncached);
+        uncached = tc_render(r, font, text, color);
+        return uncached;
+    }
+
+    unsigned hash = tc_hash(text, font, rgba);
+    TextEntry *victim = &entries[0];
+    for (int i = 0; i < TEXTCACHE_SIZE; ++i) {
+        TextEntry *e = &entries[i];
+        if (e->tex && e->hash == hash && e->font == font && e->rgba == rgba &&
+            strcmp(e->text, text) == 0) {
+            e->lastUse = ++useClock;
+            hits++;
+            return e->tex;
+        }
+        if (!e->tex) { if (victim->tex) victim = e; }
+        else if (victim->tex && e->lastUse < victim->lastUse) victim = e;
+    }
+
+    misses++;
+    SDL_Texture *tex = tc_render(r, font, text, color);
+    if (!tex) return NULL;
+    if (victim->tex) SDL_DestroyTexture(victim->tex);
+    victim->tex = tex;
+    victim->hash = hash;
+    victim->lastUse = ++useClock;
+    victim->font = font;
+    victim->rgba = rgba;
+    snprintf(victim->text, sizeof victim->text, "%s", text);
+    return tex;
+}
+
+// Destroys every cached texture.
+void textcache_clear(void)
+{
+    for (int i = 0; i < TEXTCACHE_SIZE; ++i) {
+        if (entries[i].tex) SDL_DestroyTexture(entries[i].tex);
+        entries[i].tex = NULL;
+    }
+    if (uncached) SDL_DestroyTexture(uncached);
+    uncached = NULL;
+}
+
+// Lookups since startup that found a texture / had to render one.
+void textcache_stats(unsigned long long *hitCount, unsigned long long *missCount)
+{
+    *hitCount = hits;
+    *missCount = misses;
+}
@@ -0,0 +1,168 @@
+// trace.c — scoped zone profiler with Chrome trace-event output
+// Off unless TTT_TRACE is set or the game is started with --trace.
+// Callers wrap work in TRACE_BEGIN(name, cat) / TRACE_END(), which only
+// test 'traceOn' while tracing is off. When on, each thread records
+// into its own buffer (no locks after the first zone on a thread); the
+// buffer is a ring, so a long session keeps its most recent zones.
+// On exit everything is written as JSON for chrome://tracing / Perfetto.
+//
+// Zone names and categories must be string literals (only the pointers
+// are stored).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define TRACE_EVENTS   (1 << 18)   // per thread, power of two
+#define TRACE_DEPTH    32          // nested zones per thread
+#define TRACE_THREADS  16
+
+typedef struct {
+    const char *name;
+    const char *cat;
+    Uint64 start, end;             // performance counter ticks
+} TraceEvent;
+
+typedef struct {
+    TraceEvent *events;
+    unsigned count;                // total recorded; the ring keeps the last TRACE_EVENTS
+    int depth;                     // may exceed TRACE_DEPTH; those zones aren't kept
+    TraceEvent open[TRACE_DEPTH];
+    int tid;
+    char name[24];
+    SDL_atomic_t busy;             // owner thread is inside trace_begin/trace_end
+} TraceBuffer;
+
+SDL_atomic_t traceOn;              // read by the TRACE_* macros
+static char tracePath[512];
+static Uint64 traceStart;
+static SDL_TLSID traceTls;
+static SDL_mutex *traceLock = NULL;
+static TraceBuffer *buffers[TRACE_THREADS];
+static int nBuffers = 0;
+
+static TraceBuffer *trace_buffer(void)
+{
+    TraceBuffer *b = (TraceBuffer *)SDL_TLSGet(traceTls);
+    if (b) return b;
+
+    SDL_LockMutex(traceLock);
+    if (nBuffers < TRACE_THREADS) {
+        b = calloc(1, sizeof *b);
+        if (b) b->events = malloc(sizeof(TraceEvent) * TRACE_EVENTS);
+        if (b && b->events) {
+            b->tid = nBuffers + 1;
+            snprintf(b->name, sizeof b->name, "thread %d", b->tid);
+            buffers[nBuffers++] = b;
+        } else if (b) {
+            free(b);
+            b = NULL;
+        }
+    }
+    SDL_UnlockMutex(traceLock);
+    if (b) SDL_TLSSet(traceTls, b, NULL);
+    return b;
+}
+
+// The owner marks its buffer busy, then re-checks traceOn; trace_shutdown
+// clears traceOn, then waits for busy to drop, so the two never overlap.
+static int trace_enter(TraceBuffer *b)
+{
+    SDL_AtomicSet(&b->busy, 1);
+    if (SDL_AtomicGet(&traceOn)) return 1;
+    SDL_AtomicSet(&b->busy, 0);
+    return 0;
+}
+
+void trace_begin(const char *name, const char *cat)
+{
+    TraceBuffer *b = trace_buffer();
+    if (!b || !trace_enter(b)) return;
+    if (b->depth < TRACE_DEPTH) {
+        TraceEvent *e = &b->open[b->depth];
+        e->name = name;
+        e->cat = cat;
+        e->start = SDL_GetPerformanceCounter();
+    }
+    b->depth++;
+    SDL_AtomicSet(&b->busy, 0);
+}
+
+void trace_end(void)
+{
+    TraceBuffer *b = (TraceBuffer *)SDL_TLSGet(traceTls);
+    if (!b || b->depth == 0 || !trace_enter(b)) return;
+    b->depth--;
+    if (b->depth < TRACE_DEPTH) {
+        TraceEvent *e = &b->events[b->count & (TRACE_EVENTS - 1)];
+        *e = b->open[b->depth];
+        e->end = SDL_GetPerformanceCounter();
+        b->count++;
+    }
+    SDL_AtomicSet(&b->busy, 0);
+}
+
+// Names the calling thread in the trace ("main", "metrics" ...).
+void trace_thread_name(const char *name)
+{
+    if (!SDL_AtomicGet(&traceOn)) return;
+    TraceBuffer *b = trace_buffer();
+    if (b && trace_enter(b)) {
+        snprintf(b->name, sizeof b->name, "%s", name);
+        SDL_AtomicSet(&b->busy, 0);
+    }
+}
+
+// Turns tracing off and writes every buffer to tracePath. Threads that
+// are still running stop recording; a zone they have open is dropped.
+void trace_shutdown(void)
+{
+    if (!SDL_AtomicCAS(&traceOn, 1, 0)) return;
+    SDL_LockMutex(traceLock);
+    int n = nBuffers;              // buffers created from here on stay empty
+    SDL_UnlockMutex(traceLock);
+    for (int i = 0; i < n; ++i)
+        while (SDL_AtomicGet(&buffers[i]->busy)) SDL_Delay(0);
+
+    FILE *f = fopen(tracePath, "w");
+    if (!f) { fprintf(stderr, "[trace] can't write '%s'\n", tracePath); return; }
+    setvbuf(f, NULL, _IOFBF, 1 << 16);
+
+    double usPerTick = 1e6 / (double)SDL_GetPerformanceFrequency();
+    long long written = 0, lost = 0;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    for (int i = 0; i < n; ++i) {
+        TraceBuffer *b = buffers[i];
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                i ? ",\n" : "", b->tid, b->name);
+        unsigned first = (b->count > TRACE_EVENTS) ? b->count - TRACE_EVENTS : 0;
+        lost += first;
+        for (unsigned n = first; n != b->count; ++n) {
+            const TraceEvent *e = &b->events[n & (TRACE_EVENTS - 1)];
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e->name, e->cat, b->tid,
+                    (double)(e->start - traceStart) * usPerTick,
+                    (double)(e->end - e->start) * usPerTick);
+            written++;
+        }
+    }
+    fputs("\n]}\n", f);
+    fclose(f);
+    fprintf(stderr, "[trace] %lld zones written to '%s'%s\n", written, tracePath,
+            lost ? " (oldest zones overwritten)" : "");
+}
+
+// Turns tracing on, writing to 'path' at exit.
+int trace_init(const char *path)
+{
+    if (SDL_AtomicGet(&traceOn)) return 1;
+    traceLock = SDL_CreateMutex();
+    traceTls = SDL_TLSCreate();
+    if (!traceLock || !traceTls) return 0;
+    snprintf(tracePath, sizeof tracePath, "%s", path);
+    traceStart = SDL_GetPerformanceCounter();
+    atexit(trace_shutdown);     // some screens exit() straight from SDL_QUIT
+    SDL_AtomicSet(&traceOn, 1);
+    trace_thread_name("main");
+    return 1;
+}